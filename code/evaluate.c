@@ -0,0 +1,756 @@
+/*
+ * This file is part of the micropython-ulab project, 
+ *
+ * https://github.com/v923z/micropython-ulab
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Zoltán Vörös
+*/
+    
+#include <math.h>
+#include <string.h>
+#include "py/runtime.h"
+#include "py/obj.h"
+#include "py/parsenum.h"
+#include "numerical.h"
+#include "evaluate.h"
+
+// The evaluator compiles an arithmetic expression into a short postfix program, and then runs
+// the program on blocks of ULAB_EVALUATE_BLOCK elements: the operands are loaded into a small
+// stack of blocks, and only the final results are written into the output array. This way, no
+// temporary arrays are created, and the data pass through the memory only once.
+
+typedef struct _evaluate_function_t {
+    qstr name;
+    mp_float_t (*f)(mp_float_t);
+} evaluate_function_t;
+
+STATIC const evaluate_function_t evaluate_functions[] = {
+    { MP_QSTR_abs, MICROPY_FLOAT_C_FUN(fabs) },
+    { MP_QSTR_acos, MICROPY_FLOAT_C_FUN(acos) },
+    { MP_QSTR_acosh, MICROPY_FLOAT_C_FUN(acosh) },
+    { MP_QSTR_asin, MICROPY_FLOAT_C_FUN(asin) },
+    { MP_QSTR_asinh, MICROPY_FLOAT_C_FUN(asinh) },
+    { MP_QSTR_atan, MICROPY_FLOAT_C_FUN(atan) },
+    { MP_QSTR_atanh, MICROPY_FLOAT_C_FUN(atanh) },
+    { MP_QSTR_ceil, MICROPY_FLOAT_C_FUN(ceil) },
+    { MP_QSTR_cos, MICROPY_FLOAT_C_FUN(cos) },
+    { MP_QSTR_erf, MICROPY_FLOAT_C_FUN(erf) },
+    { MP_QSTR_erfc, MICROPY_FLOAT_C_FUN(erfc) },
+    { MP_QSTR_exp, MICROPY_FLOAT_C_FUN(exp) },
+    { MP_QSTR_expm1, MICROPY_FLOAT_C_FUN(expm1) },
+    { MP_QSTR_floor, MICROPY_FLOAT_C_FUN(floor) },
+    { MP_QSTR_gamma, MICROPY_FLOAT_C_FUN(tgamma) },
+    { MP_QSTR_lgamma, MICROPY_FLOAT_C_FUN(lgamma) },
+    { MP_QSTR_log, MICROPY_FLOAT_C_FUN(log) },
+    { MP_QSTR_log10, MICROPY_FLOAT_C_FUN(log10) },
+    { MP_QSTR_log2, MICROPY_FLOAT_C_FUN(log2) },
+    { MP_QSTR_sin, MICROPY_FLOAT_C_FUN(sin) },
+    { MP_QSTR_sinh, MICROPY_FLOAT_C_FUN(sinh) },
+    { MP_QSTR_sqrt, MICROPY_FLOAT_C_FUN(sqrt) },
+    { MP_QSTR_tan, MICROPY_FLOAT_C_FUN(tan) },
+    { MP_QSTR_tanh, MICROPY_FLOAT_C_FUN(tanh) },
+};
+
+void evaluate_init(evaluate_program_t *program) {
+    program->len = 0;
+    program->depth = 0;
+    program->max_depth = 0;
+    program->nconstants = 0;
+    program->noperands = 0;
+}
+
+void evaluate_emit(evaluate_program_t *program, uint8_t opcode, int16_t argument) {
+    // appends opcode, and, if it is non-negative, its argument to the program,
+    // and keeps track of the depth of the stack
+    if(program->len + 2 > EVALUATE_MAX_CODE) {
+        mp_raise_ValueError("expression is too long");
+    }
+    program->code[program->len++] = opcode;
+    if(argument >= 0) {
+        program->code[program->len++] = (uint8_t)argument;
+    }
+    if((opcode == EVALUATE_LOAD) || (opcode == EVALUATE_CONSTANT)) {
+        if(++program->depth > EVALUATE_MAX_STACK) {
+            mp_raise_ValueError("expression is too deeply nested");
+        }
+        if(program->depth > program->max_depth) {
+            program->max_depth = program->depth;
+        }
+    } else if((opcode != EVALUATE_NEGATIVE) && (opcode != EVALUATE_FUNCTION)) {
+        program->depth--;
+    }
+}
+
+uint8_t evaluate_add_constant(evaluate_program_t *program, mp_float_t value) {
+    if(program->nconstants == EVALUATE_MAX_CONSTANTS) {
+        mp_raise_ValueError("too many constants in expression");
+    }
+    program->constants[program->nconstants] = value;
+    return program->nconstants++;
+}
+
+uint8_t evaluate_add_operand(evaluate_program_t *program, ndarray_obj_t *ndarray) {
+    // returns the index of ndarray in the list of operands; an ndarray is stored only once,
+    // no matter how many times it occurs in the expression
+    for(uint8_t i=0; i < program->noperands; i++) {
+        if(program->operands[i] == ndarray) {
+            return i;
+        }
+    }
+    if(program->noperands == EVALUATE_MAX_OPERANDS) {
+        mp_raise_ValueError("too many operands in expression");
+    }
+    ndarray_check_real(ndarray);
+    program->operands[program->noperands] = ndarray;
+    return program->noperands++;
+}
+
+typedef struct _evaluate_parser_t {
+    const char *cursor;
+    const char *end;
+    mp_map_t *variables;
+    evaluate_program_t *program;
+    uint8_t nesting;
+} evaluate_parser_t;
+
+STATIC void evaluate_expression(evaluate_parser_t *);
+
+STATIC char evaluate_peek(evaluate_parser_t *parser) {
+    // skips the white space, and returns the next character, or 0 at the end of the string
+    while((parser->cursor < parser->end) && ((*parser->cursor == ' ') || (*parser->cursor == '\t'))) {
+        parser->cursor++;
+    }
+    return (parser->cursor < parser->end) ? *parser->cursor : 0;
+}
+
+STATIC void evaluate_expect(evaluate_parser_t *parser, char c) {
+    if(evaluate_peek(parser) != c) {
+        mp_raise_ValueError("invalid syntax in expression");
+    }
+    parser->cursor++;
+}
+
+STATIC bool evaluate_is_name(char c, bool first) {
+    return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || (c == '_') ||
+           (!first && (c >= '0') && (c <= '9'));
+}
+
+STATIC void evaluate_number(evaluate_parser_t *parser) {
+    // numbers are parsed by micropython itself, so that they mean the same as in python code
+    const char *start = parser->cursor;
+    while(parser->cursor < parser->end) {
+        char c = *parser->cursor;
+        if(((c >= '0') && (c <= '9')) || (c == '.')) {
+            parser->cursor++;
+        } else if(((c == 'e') || (c == 'E')) && (parser->cursor + 1 < parser->end)) {
+            parser->cursor++;
+            if((*parser->cursor == '+') || (*parser->cursor == '-')) {
+                parser->cursor++;
+            }
+        } else {
+            break;
+        }
+    }
+    mp_obj_t number = mp_parse_num_decimal(start, parser->cursor - start, false, false, NULL);
+    evaluate_emit(parser->program, EVALUATE_CONSTANT, evaluate_add_constant(parser->program, mp_obj_get_float(number)));
+}
+
+STATIC void evaluate_name(evaluate_parser_t *parser) {
+    // a name is either a function, if it is followed by a parenthesis, or a variable,
+    // which must be supplied as a keyword argument
+    const char *start = parser->cursor;
+    while((parser->cursor < parser->end) && evaluate_is_name(*parser->cursor, false)) {
+        parser->cursor++;
+    }
+    qstr name = qstr_find_strn(start, parser->cursor - start);
+    if(evaluate_peek(parser) == '(') {
+        parser->cursor++;
+        for(uint8_t i=0; i < MP_ARRAY_SIZE(evaluate_functions); i++) {
+            if(evaluate_functions[i].name == name) {
+                evaluate_expression(parser);
+                evaluate_expect(parser, ')');
+                evaluate_emit(parser->program, EVALUATE_FUNCTION, i);
+                return;
+            }
+        }
+        mp_raise_ValueError("unknown function in expression");
+    }
+    mp_map_elem_t *elem = NULL;
+    if((name != MP_QSTRnull) && (name != MP_QSTR_out)) {
+        elem = mp_map_lookup(parser->variables, MP_OBJ_NEW_QSTR(name), MP_MAP_LOOKUP);
+    }
+    if(elem == NULL) {
+        mp_raise_msg(&mp_type_NameError, "name in expression is not defined");
+    }
+    if(MP_OBJ_IS_TYPE(elem->value, &ulab_ndarray_type)) {
+        evaluate_emit(parser->program, EVALUATE_LOAD, evaluate_add_operand(parser->program, MP_OBJ_TO_PTR(elem->value)));
+    } else if(mp_obj_is_float(elem->value) || mp_obj_is_integer(elem->value)) {
+        evaluate_emit(parser->program, EVALUATE_CONSTANT, evaluate_add_constant(parser->program, mp_obj_get_float(elem->value)));
+    } else {
+        mp_raise_TypeError("variables must be ndarrays, or numbers");
+    }
+}
+
+STATIC void evaluate_atom(evaluate_parser_t *parser) {
+    char c = evaluate_peek(parser);
+    if(c == '(') {
+        parser->cursor++;
+        evaluate_expression(parser);
+        evaluate_expect(parser, ')');
+    } else if(((c >= '0') && (c <= '9')) || (c == '.')) {
+        evaluate_number(parser);
+    } else if(evaluate_is_name(c, true)) {
+        evaluate_name(parser);
+    } else {
+        mp_raise_ValueError("invalid syntax in expression");
+    }
+}
+
+STATIC void evaluate_unary(evaluate_parser_t *parser) {
+    // unary minus binds more weakly than the power, i.e., -x**2 is -(x**2), as in python; 
+    // all recursion of the parser passes through here, and since neither parentheses, 
+    // nor unary plus emit code, the nesting is limited explicitly, before it exhausts the C stack
+    if(++parser->nesting > EVALUATE_MAX_STACK) {
+        mp_raise_ValueError("expression is too deeply nested");
+    }
+    char c = evaluate_peek(parser);
+    if((c == '-') || (c == '+')) {
+        parser->cursor++;
+        evaluate_unary(parser);
+        if(c == '-') {
+            evaluate_emit(parser->program, EVALUATE_NEGATIVE, -1);
+        }
+    } else {
+        evaluate_atom(parser);
+        if((evaluate_peek(parser) == '*') && (parser->cursor + 1 < parser->end) && (parser->cursor[1] == '*')) {
+            parser->cursor += 2;
+            evaluate_unary(parser);
+            evaluate_emit(parser->program, EVALUATE_POWER, -1);
+        }
+    }
+    parser->nesting--;
+}
+
+STATIC void evaluate_term(evaluate_parser_t *parser) {
+    evaluate_unary(parser);
+    for(;;) {
+        char c = evaluate_peek(parser);
+        if((c != '*') && (c != '/')) {
+            return;
+        }
+        parser->cursor++;
+        evaluate_unary(parser);
+        evaluate_emit(parser->program, (c == '*') ? EVALUATE_MULTIPLY : EVALUATE_DIVIDE, -1);
+    }
+}
+
+STATIC void evaluate_expression(evaluate_parser_t *parser) {
+    evaluate_term(parser);
+    for(;;) {
+        char c = evaluate_peek(parser);
+        if((c != '+') && (c != '-')) {
+            return;
+        }
+        parser->cursor++;
+        evaluate_term(parser);
+        evaluate_emit(parser->program, (c == '+') ? EVALUATE_ADD : EVALUATE_SUBTRACT, -1);
+    }
+}
+
+STATIC void evaluate_load(ndarray_obj_t *operand, int32_t *strides, size_t *shape, size_t *coords, size_t n, mp_float_t *dest) {
+    // converts n elements of operand, starting at the position coords of the output, into dest;
+    // strides are in bytes, and are 0 along the axes, along which the operand is broadcast
+    size_t c[ULAB_MAX_DIMS];
+    uint8_t *source = (uint8_t *)operand->items;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        c[i] = coords[i];
+        source += c[i] * strides[i];
+    }
+    uint8_t typecode = operand->array->typecode;
+    int32_t stride = strides[ULAB_MAX_DIMS-1];
+    while(n > 0) {
+        // the elements are copied row by row, so that the innermost loop is a simple one
+        size_t run = shape[ULAB_MAX_DIMS-1] - c[ULAB_MAX_DIMS-1];
+        if(run > n) {
+            run = n;
+        }
+        if(typecode == NDARRAY_UINT8) {
+            EVALUATE_COPY(uint8_t, source, stride, run, dest, a);
+        } else if(typecode == NDARRAY_INT8) {
+            EVALUATE_COPY(int8_t, source, stride, run, dest, a);
+        } else if(typecode == NDARRAY_UINT16) {
+            EVALUATE_COPY(uint16_t, source, stride, run, dest, a);
+        } else if(typecode == NDARRAY_INT16) {
+            EVALUATE_COPY(int16_t, source, stride, run, dest, a);
+        } else if(typecode == NDARRAY_UINT32) {
+            EVALUATE_COPY(uint32_t, source, stride, run, dest, a);
+        } else if(typecode == NDARRAY_INT32) {
+            EVALUATE_COPY(int32_t, source, stride, run, dest, a);
+        } else if(NDARRAY_IS_FLOAT32(typecode)) {
+            EVALUATE_COPY(float, source, stride, run, dest, a);
+        } else if(typecode == NDARRAY_FLOAT16) {
+            EVALUATE_COPY(uint16_t, source, stride, run, dest, ndarray_float16_to_float(a));
+        } else {
+            EVALUATE_COPY(mp_float_t, source, stride, run, dest, a);
+        }
+        dest += run;
+        n -= run;
+        source += run * stride;
+        c[ULAB_MAX_DIMS-1] += run;
+        for(uint8_t i=ULAB_MAX_DIMS-1; (i > 0) && (c[i] == shape[i]); i--) {
+            source += strides[i-1] - c[i] * strides[i];
+            c[i] = 0;
+            c[i-1]++;
+        }
+    }
+}
+
+STATIC void evaluate_block(evaluate_program_t *program, int32_t (*strides)[ULAB_MAX_DIMS], size_t *shape,
+                           size_t *coords, size_t n, mp_float_t *stack) {
+    // runs the program on n elements starting at coords; the result is left in the first block of the stack
+    mp_float_t *top = stack - ULAB_EVALUATE_BLOCK;
+    for(uint8_t pc=0; pc < program->len; pc++) {
+        switch(program->code[pc]) {
+            case EVALUATE_LOAD:
+                top += ULAB_EVALUATE_BLOCK;
+                pc++;
+                evaluate_load(program->operands[program->code[pc]], strides[program->code[pc]], shape, coords, n, top);
+                break;
+            case EVALUATE_CONSTANT:
+                top += ULAB_EVALUATE_BLOCK;
+                pc++;
+                for(size_t i=0; i < n; i++) {
+                    top[i] = program->constants[program->code[pc]];
+                }
+                break;
+            case EVALUATE_ADD:
+                EVALUATE_BINARY(top, n, +);
+                break;
+            case EVALUATE_SUBTRACT:
+                EVALUATE_BINARY(top, n, -);
+                break;
+            case EVALUATE_MULTIPLY:
+                EVALUATE_BINARY(top, n, *);
+                break;
+            case EVALUATE_DIVIDE:
+                EVALUATE_BINARY(top, n, /);
+                break;
+            case EVALUATE_POWER:
+                top -= ULAB_EVALUATE_BLOCK;
+                for(size_t i=0; i < n; i++) {
+                    top[i] = MICROPY_FLOAT_C_FUN(pow)(top[i], top[i+ULAB_EVALUATE_BLOCK]);
+                }
+                break;
+            case EVALUATE_NEGATIVE:
+                for(size_t i=0; i < n; i++) {
+                    top[i] = -top[i];
+                }
+                break;
+            case EVALUATE_FUNCTION: {
+                pc++;
+                mp_float_t (*f)(mp_float_t) = evaluate_functions[program->code[pc]].f;
+                for(size_t i=0; i < n; i++) {
+                    top[i] = f(top[i]);
+                }
+                break;
+            }
+        }
+    }
+}
+
+STATIC uint8_t evaluate_shape(evaluate_program_t *program, size_t *shape) {
+    // writes the shape of the operands broadcast against each other into shape, and returns
+    // the number of dimensions
+    uint8_t ndim = 0;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        shape[i] = 1;
+    }
+    for(uint8_t j=0; j < program->noperands; j++) {
+        ndarray_obj_t *operand = program->operands[j];
+        if(operand->ndim > ndim) {
+            ndim = operand->ndim;
+        }
+        for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+            if((operand->shape[i] != shape[i]) && (operand->shape[i] != 1) && (shape[i] != 1)) {
+                mp_raise_ValueError("operands could not be broadcast together");
+            }
+            if(operand->shape[i] != 1) {
+                shape[i] = operand->shape[i];
+            }
+        }
+    }
+    return ndim;
+}
+
+// The sink receives the n results of a block; start is the flat index of the first result
+typedef void (*evaluate_sink_t)(void *, size_t , mp_float_t *, size_t );
+
+STATIC void evaluate_stream(evaluate_program_t *program, ndarray_obj_t *target, size_t *shape, 
+                            evaluate_sink_t sink, void *state) {
+    // runs the program on all elements of shape block by block, and passes the results to sink;
+    // target is the output array, if there is one, and the operands are detached from it
+    size_t len = 1;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        len *= shape[i];
+    }
+    int32_t strides[EVALUATE_MAX_OPERANDS][ULAB_MAX_DIMS];
+    for(uint8_t j=0; j < program->noperands; j++) {
+        if(target != NULL) {
+            // an operand, that shares its storage with the output, could be overwritten, before it is read
+            program->operands[j] = ndarray_detach(program->operands[j], target);
+        }
+        ndarray_broadcast_strides(program->operands[j], strides[j]);
+        uint8_t _sizeof = ndarray_itemsize(program->operands[j]->array->typecode);
+        for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+            strides[j][i] *= _sizeof;
+        }
+    }
+    size_t block = (len < ULAB_EVALUATE_BLOCK) ? len : ULAB_EVALUATE_BLOCK;
+    // the stack holds at least one block, even if the output is empty
+    mp_float_t *stack = m_new(mp_float_t, (program->max_depth - 1) * ULAB_EVALUATE_BLOCK + block + 1);
+    size_t coords[ULAB_MAX_DIMS];
+    for(size_t start=0; start < len; start += block) {
+        size_t n = (len - start < block) ? len - start : block;
+        size_t index = start;
+        for(uint8_t i=ULAB_MAX_DIMS; i > 0; i--) {
+            coords[i-1] = index % shape[i-1];
+            index /= shape[i-1];
+        }
+        evaluate_block(program, strides, shape, coords, n, stack);
+        sink(state, start, stack, n);
+    }
+    m_del(mp_float_t, stack, (program->max_depth - 1) * ULAB_EVALUATE_BLOCK + block + 1);
+}
+
+STATIC void evaluate_store(void *state, size_t start, mp_float_t *results, size_t n) {
+    memcpy((mp_float_t *)state + start, results, n * sizeof(mp_float_t));
+}
+
+mp_obj_t evaluate_run(evaluate_program_t *program, mp_obj_t out) {
+    // runs the compiled program on the broadcast shape of its operands, and returns a float
+    // ndarray, or a float, if there are no operands; the results are written into out, if it is given
+    if(program->noperands == 0) {
+        if(out != mp_const_none) {
+            mp_raise_TypeError("out can be used with ndarrays only");
+        }
+        mp_float_t *stack = m_new(mp_float_t, (program->max_depth - 1) * ULAB_EVALUATE_BLOCK + 1);
+        size_t shape[ULAB_MAX_DIMS] = {1, 1, 1, 1}, coords[ULAB_MAX_DIMS] = {0, 0, 0, 0};
+        evaluate_block(program, NULL, shape, coords, 1, stack);
+        mp_obj_t result = mp_obj_new_float(stack[0]);
+        m_del(mp_float_t, stack, (program->max_depth - 1) * ULAB_EVALUATE_BLOCK + 1);
+        return result;
+    }
+    size_t shape[ULAB_MAX_DIMS];
+    uint8_t ndim = evaluate_shape(program, shape);
+    ndarray_obj_t *ndarray = ndarray_binary_output(ndim, shape, NDARRAY_FLOAT, (out == mp_const_none) ? NULL : MP_OBJ_TO_PTR(out));
+    evaluate_stream(program, ndarray, shape, evaluate_store, ndarray->items);
+    return MP_OBJ_FROM_PTR(ndarray);
+}
+
+mp_obj_t evaluate_evaluate(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    // evaluate(expression, out=None, **variables): the variables of the expression are
+    // taken from the keyword arguments, and can be ndarrays, or numbers
+    if(n_args != 1) {
+        mp_raise_TypeError("evaluate takes a single positional argument");
+    }
+    size_t len;
+    evaluate_program_t program;
+    evaluate_init(&program);
+    evaluate_parser_t parser;
+    parser.cursor = mp_obj_str_get_data(pos_args[0], &len);
+    parser.end = parser.cursor + len;
+    parser.variables = kw_args;
+    parser.program = &program;
+    parser.nesting = 0;
+    evaluate_expression(&parser);
+    if(evaluate_peek(&parser) != 0) {
+        mp_raise_ValueError("invalid syntax in expression");
+    }
+    mp_map_elem_t *out = mp_map_lookup(kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_out), MP_MAP_LOOKUP);
+    return evaluate_run(&program, (out == NULL) ? mp_const_none : out->value);
+}
+
+// Lazy arrays record the arithmetic done on them in a tree, instead of computing the results. 
+// When the values are needed, the tree is compiled into a program of the evaluator, so that 
+// the whole expression is computed in a single pass, without temporary arrays.
+
+STATIC evaluate_lazy_obj_t *evaluate_lazy_new(uint8_t opcode, mp_obj_t left, mp_obj_t right) {
+    evaluate_lazy_obj_t *node = m_new_obj(evaluate_lazy_obj_t);
+    node->base.type = &ulab_lazy_type;
+    node->opcode = opcode;
+    node->function = 0;
+    node->value = 0.0;
+    node->left = left;
+    node->right = right;
+    // the resources of the node are added up from those of its operands; an ndarray that occurs 
+    // more than once is counted each time, so that noperands is an upper bound
+    if((opcode == EVALUATE_LOAD) || (opcode == EVALUATE_CONSTANT)) {
+        node->len = 2;
+        node->depth = 1;
+        node->noperands = (opcode == EVALUATE_LOAD);
+        node->nconstants = (opcode == EVALUATE_CONSTANT);
+    } else {
+        evaluate_lazy_obj_t *l = MP_OBJ_TO_PTR(left);
+        node->len = l->len + ((opcode == EVALUATE_FUNCTION) ? 2 : 1);
+        node->depth = l->depth;
+        node->noperands = l->noperands;
+        node->nconstants = l->nconstants;
+        if((opcode != EVALUATE_NEGATIVE) && (opcode != EVALUATE_FUNCTION)) {
+            // the right operand is computed on top of the left one
+            evaluate_lazy_obj_t *r = MP_OBJ_TO_PTR(right);
+            node->len += r->len;
+            node->depth = (l->depth > r->depth) ? l->depth : r->depth + 1;
+            node->noperands += r->noperands;
+            node->nconstants += r->nconstants;
+        }
+    }
+    return node;
+}
+
+STATIC mp_obj_t evaluate_lazy_operand(mp_obj_t oin) {
+    // returns oin as a lazy array, or MP_OBJ_NULL, if it can't be part of an expression
+    if(MP_OBJ_IS_TYPE(oin, &ulab_lazy_type)) {
+        return oin;
+    } else if(MP_OBJ_IS_TYPE(oin, &ulab_ndarray_type)) {
+        ndarray_check_real(MP_OBJ_TO_PTR(oin));
+        return MP_OBJ_FROM_PTR(evaluate_lazy_new(EVALUATE_LOAD, oin, MP_OBJ_NULL));
+    } else if(mp_obj_is_float(oin) || mp_obj_is_integer(oin)) {
+        evaluate_lazy_obj_t *node = evaluate_lazy_new(EVALUATE_CONSTANT, MP_OBJ_NULL, MP_OBJ_NULL);
+        node->value = mp_obj_get_float(oin);
+        return MP_OBJ_FROM_PTR(node);
+    }
+    return MP_OBJ_NULL;
+}
+
+STATIC bool evaluate_lazy_fits(evaluate_lazy_obj_t *node) {
+    // evaluate_emit needs room for two bytes before each opcode
+    return (node->len < EVALUATE_MAX_CODE) && (node->depth <= EVALUATE_MAX_STACK) && 
+           (node->noperands <= EVALUATE_MAX_OPERANDS) && (node->nconstants <= EVALUATE_MAX_CONSTANTS);
+}
+
+STATIC evaluate_lazy_obj_t *evaluate_lazy_node(uint8_t opcode, mp_obj_t left, mp_obj_t right) {
+    // returns a new node of the tree; if the tree would not fit into a program of the evaluator, 
+    // the larger operand is computed first, and is replaced by its values, so that 
+    // expressions of any length can be built
+    evaluate_lazy_obj_t *node = evaluate_lazy_new(opcode, left, right);
+    while(!evaluate_lazy_fits(node)) {
+        evaluate_lazy_obj_t *l = MP_OBJ_TO_PTR(left);
+        if((right == MP_OBJ_NULL) || (l->len >= ((evaluate_lazy_obj_t *)MP_OBJ_TO_PTR(right))->len)) {
+            left = evaluate_lazy_operand(evaluate_lazy_run(left, mp_const_none));
+        } else {
+            right = evaluate_lazy_operand(evaluate_lazy_run(right, mp_const_none));
+        }
+        node = evaluate_lazy_new(opcode, left, right);
+    }
+    return node;
+}
+
+STATIC void evaluate_lazy_compile(evaluate_program_t *program, evaluate_lazy_obj_t *node, size_t level) {
+    // each node emits at least one byte, so a tree deeper than the longest program can't be 
+    // compiled; this also bounds the recursion
+    if(level > EVALUATE_MAX_CODE) {
+        mp_raise_ValueError("expression is too long");
+    }
+    switch(node->opcode) {
+        case EVALUATE_LOAD:
+            evaluate_emit(program, EVALUATE_LOAD, evaluate_add_operand(program, MP_OBJ_TO_PTR(node->left)));
+            break;
+        case EVALUATE_CONSTANT:
+            evaluate_emit(program, EVALUATE_CONSTANT, evaluate_add_constant(program, node->value));
+            break;
+        case EVALUATE_NEGATIVE:
+            evaluate_lazy_compile(program, MP_OBJ_TO_PTR(node->left), level+1);
+            evaluate_emit(program, EVALUATE_NEGATIVE, -1);
+            break;
+        case EVALUATE_FUNCTION:
+            evaluate_lazy_compile(program, MP_OBJ_TO_PTR(node->left), level+1);
+            evaluate_emit(program, EVALUATE_FUNCTION, node->function);
+            break;
+        default:
+            evaluate_lazy_compile(program, MP_OBJ_TO_PTR(node->left), level+1);
+            evaluate_lazy_compile(program, MP_OBJ_TO_PTR(node->right), level+1);
+            evaluate_emit(program, node->opcode, -1);
+            break;
+    }
+}
+
+mp_obj_t evaluate_lazy_run(mp_obj_t self_in, mp_obj_t out) {
+    // computes the lazy array self_in, and returns the results in a float ndarray, or in out
+    evaluate_program_t program;
+    evaluate_init(&program);
+    evaluate_lazy_compile(&program, MP_OBJ_TO_PTR(self_in), 0);
+    return evaluate_run(&program, out);
+}
+
+mp_obj_t evaluate_lazy_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    (void) type;
+    mp_arg_check_num(n_args, n_kw, 1, 1, false);
+    if(!MP_OBJ_IS_TYPE(args[0], &ulab_ndarray_type) && !MP_OBJ_IS_TYPE(args[0], &ulab_lazy_type)) {
+        mp_raise_TypeError("input must be an ndarray");
+    }
+    return evaluate_lazy_operand(args[0]);
+}
+
+void evaluate_lazy_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    ndarray_print(print, evaluate_lazy_run(self_in, mp_const_none), kind);
+}
+
+mp_obj_t evaluate_lazy_compute(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+        { MP_QSTR_out, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    return evaluate_lazy_run(args[0].u_obj, args[1].u_obj);
+}
+
+mp_obj_t evaluate_lazy_unary_op(mp_unary_op_t op, mp_obj_t self_in) {
+    switch(op) {
+        case MP_UNARY_OP_POSITIVE:
+            return self_in;
+        case MP_UNARY_OP_NEGATIVE:
+            return MP_OBJ_FROM_PTR(evaluate_lazy_node(EVALUATE_NEGATIVE, self_in, MP_OBJ_NULL));
+        case MP_UNARY_OP_ABS: {
+            // abs is the first entry of evaluate_functions
+            evaluate_lazy_obj_t *node = evaluate_lazy_node(EVALUATE_FUNCTION, self_in, MP_OBJ_NULL);
+            node->function = 0;
+            return MP_OBJ_FROM_PTR(node);
+        }
+        default:
+            return ndarray_unary_op(op, evaluate_lazy_run(self_in, mp_const_none));
+    }
+}
+
+mp_obj_t evaluate_lazy_binary_op(mp_binary_op_t op, mp_obj_t lhs, mp_obj_t rhs) {
+    // the arithmetic operators are deferred, and all others are run on the computed values. 
+    // The function is called with a lazy lhs, or, from ndarray_binary_op, with a lazy rhs; 
+    // in the latter case, an in-place operator has to modify lhs, so that it can't be deferred
+    bool lazy = MP_OBJ_IS_TYPE(lhs, &ulab_lazy_type);
+    mp_binary_op_t arithmetic = op;
+    mp_obj_t left = lhs, right = rhs;
+    if((op >= MP_BINARY_OP_REVERSE_OR) && (op <= MP_BINARY_OP_REVERSE_POWER)) {
+        left = rhs;
+        right = lhs;
+        arithmetic = op - MP_BINARY_OP_REVERSE_OR + MP_BINARY_OP_OR;
+    } else if(lazy && (op >= MP_BINARY_OP_INPLACE_OR) && (op <= MP_BINARY_OP_INPLACE_POWER)) {
+        arithmetic = op - MP_BINARY_OP_INPLACE_OR + MP_BINARY_OP_OR;
+    }
+    uint8_t opcode;
+    switch(arithmetic) {
+        case MP_BINARY_OP_ADD:
+            opcode = EVALUATE_ADD;
+            break;
+        case MP_BINARY_OP_SUBTRACT:
+            opcode = EVALUATE_SUBTRACT;
+            break;
+        case MP_BINARY_OP_MULTIPLY:
+            opcode = EVALUATE_MULTIPLY;
+            break;
+        case MP_BINARY_OP_TRUE_DIVIDE:
+            opcode = EVALUATE_DIVIDE;
+            break;
+        case MP_BINARY_OP_POWER:
+            opcode = EVALUATE_POWER;
+            break;
+        default:
+            if(!lazy) {
+                return MP_OBJ_NULL;
+            }
+            return ndarray_binary_op(op, evaluate_lazy_run(lhs, mp_const_none), rhs);
+    }
+    left = evaluate_lazy_operand(left);
+    right = evaluate_lazy_operand(right);
+    if((left == MP_OBJ_NULL) || (right == MP_OBJ_NULL)) {
+        return MP_OBJ_NULL;
+    }
+    return MP_OBJ_FROM_PTR(evaluate_lazy_node(opcode, left, right));
+}
+
+mp_obj_t evaluate_lazy_function(mp_float_t (*f)(mp_float_t), mp_obj_t self_in, mp_obj_t out) {
+    // applies one of the functions of the evaluator to the lazy array self_in; the result is 
+    // deferred, unless it is to be written into out
+    uint8_t i = 0;
+    while((i < MP_ARRAY_SIZE(evaluate_functions)) && (evaluate_functions[i].f != f)) {
+        i++;
+    }
+    if(i == MP_ARRAY_SIZE(evaluate_functions)) {
+        mp_raise_NotImplementedError("function can't be applied to lazy arrays");
+    }
+    evaluate_lazy_obj_t *node = evaluate_lazy_node(EVALUATE_FUNCTION, self_in, MP_OBJ_NULL);
+    node->function = i;
+    if(out != mp_const_none) {
+        return evaluate_lazy_run(MP_OBJ_FROM_PTR(node), out);
+    }
+    return MP_OBJ_FROM_PTR(node);
+}
+
+typedef struct _evaluate_reduction_t {
+    uint8_t type;
+    mp_float_t sum;
+    mp_float_t sq_sum;
+    mp_float_t best;
+    size_t best_index;
+} evaluate_reduction_t;
+
+STATIC void evaluate_accumulate(void *state, size_t start, mp_float_t *results, size_t n) {
+    evaluate_reduction_t *reduction = (evaluate_reduction_t *)state;
+    if((reduction->type == NUMERICAL_SUM) || (reduction->type == NUMERICAL_MEAN) || (reduction->type == NUMERICAL_STD)) {
+        for(size_t i=0; i < n; i++) {
+            reduction->sum += results[i];
+        }
+        if(reduction->type == NUMERICAL_STD) {
+            for(size_t i=0; i < n; i++) {
+                reduction->sq_sum += results[i] * results[i];
+            }
+        }
+    } else {
+        if(start == 0) {
+            reduction->best = results[0];
+            reduction->best_index = 0;
+        }
+        bool max = (reduction->type == NUMERICAL_MAX) || (reduction->type == NUMERICAL_ARGMAX);
+        for(size_t i=0; i < n; i++) {
+            if(max ? (results[i] > reduction->best) : (results[i] < reduction->best)) {
+                reduction->best = results[i];
+                reduction->best_index = start + i;
+            }
+        }
+    }
+}
+
+mp_obj_t evaluate_lazy_reduce(mp_obj_t self_in, uint8_t type) {
+    // reduces the flattened lazy array self_in, while it is being computed, so that 
+    // the values of the expression are never stored; type is one of NUMERICAL_FUNCTION_TYPE
+    evaluate_program_t program;
+    evaluate_init(&program);
+    evaluate_lazy_compile(&program, MP_OBJ_TO_PTR(self_in), 0);
+    size_t shape[ULAB_MAX_DIMS];
+    evaluate_shape(&program, shape);
+    size_t len = 1;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        len *= shape[i];
+    }
+    evaluate_reduction_t reduction = { .type = type, .sum = 0.0, .sq_sum = 0.0, .best = 0.0, .best_index = 0 };
+    if((len == 0) && (type != NUMERICAL_SUM)) {
+        mp_raise_ValueError("data length is 0!");
+    }
+    evaluate_stream(&program, NULL, shape, evaluate_accumulate, &reduction);
+    switch(type) {
+        case NUMERICAL_SUM:
+            return mp_obj_new_float(reduction.sum);
+        case NUMERICAL_MEAN:
+            return mp_obj_new_float(reduction.sum/len);
+        case NUMERICAL_STD:
+            reduction.sum /= len; // this is now the mean!
+            return mp_obj_new_float(MICROPY_FLOAT_C_FUN(sqrt)(reduction.sq_sum/len-reduction.sum*reduction.sum));
+        case NUMERICAL_MIN:
+        case NUMERICAL_MAX:
+            return mp_obj_new_float(reduction.best);
+        default:
+            return mp_obj_new_int_from_uint(reduction.best_index);
+    }
+}
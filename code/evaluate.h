@@ -0,0 +1,107 @@
+/*
+ * This file is part of the micropython-ulab project, 
+ *
+ * https://github.com/v923z/micropython-ulab
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Zoltán Vörös
+*/
+    
+#ifndef _EVALUATE_
+#define _EVALUATE_
+
+#include "ndarray.h"
+
+// The number of elements that are computed in one go. Each level of the evaluation stack
+// takes up ULAB_EVALUATE_BLOCK*sizeof(mp_float_t) bytes, so this should fit into the cache
+#ifndef ULAB_EVALUATE_BLOCK
+#define ULAB_EVALUATE_BLOCK (64)
+#endif
+
+#define EVALUATE_MAX_CODE (128)
+#define EVALUATE_MAX_CONSTANTS (16)
+#define EVALUATE_MAX_OPERANDS (16)
+#define EVALUATE_MAX_STACK (16)
+
+// The opcodes of the evaluator; LOAD, CONSTANT, and FUNCTION are followed by a single byte,
+// the index of the operand, of the constant, or of the function, respectively
+enum EVALUATE_OPCODE {
+    EVALUATE_LOAD,
+    EVALUATE_CONSTANT,
+    EVALUATE_ADD,
+    EVALUATE_SUBTRACT,
+    EVALUATE_MULTIPLY,
+    EVALUATE_DIVIDE,
+    EVALUATE_POWER,
+    EVALUATE_NEGATIVE,
+    EVALUATE_FUNCTION,
+};
+
+typedef struct _evaluate_program_t {
+    uint8_t code[EVALUATE_MAX_CODE];
+    uint8_t len;
+    // the current, and the largest number of blocks on the stack
+    uint8_t depth;
+    uint8_t max_depth;
+    uint8_t nconstants;
+    mp_float_t constants[EVALUATE_MAX_CONSTANTS];
+    uint8_t noperands;
+    ndarray_obj_t *operands[EVALUATE_MAX_OPERANDS];
+} evaluate_program_t;
+
+void evaluate_init(evaluate_program_t *);
+void evaluate_emit(evaluate_program_t *, uint8_t , int16_t );
+uint8_t evaluate_add_constant(evaluate_program_t *, mp_float_t );
+uint8_t evaluate_add_operand(evaluate_program_t *, ndarray_obj_t *);
+mp_obj_t evaluate_run(evaluate_program_t *, mp_obj_t );
+mp_obj_t evaluate_evaluate(size_t , const mp_obj_t *, mp_map_t *);
+
+// A node of the expression tree of a lazy array: a LOAD node holds the ndarray in left, a CONSTANT 
+// node holds its value, NEGATIVE, and FUNCTION nodes have a single operand in left, while 
+// the arithmetic nodes have two operands, left and right. len, depth, noperands, and nconstants 
+// are the resources that the compiled tree takes up in an evaluate_program_t (at most)
+typedef struct _evaluate_lazy_obj_t {
+    mp_obj_base_t base;
+    uint8_t opcode;
+    uint8_t function;
+    uint16_t len;
+    uint16_t depth;
+    uint16_t noperands;
+    uint16_t nconstants;
+    mp_float_t value;
+    mp_obj_t left;
+    mp_obj_t right;
+} evaluate_lazy_obj_t;
+
+extern const mp_obj_type_t ulab_lazy_type;
+
+mp_obj_t evaluate_lazy_make_new(const mp_obj_type_t *, size_t , size_t , const mp_obj_t *);
+void evaluate_lazy_print(const mp_print_t *, mp_obj_t , mp_print_kind_t );
+mp_obj_t evaluate_lazy_unary_op(mp_unary_op_t , mp_obj_t );
+mp_obj_t evaluate_lazy_binary_op(mp_binary_op_t , mp_obj_t , mp_obj_t );
+mp_obj_t evaluate_lazy_compute(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t evaluate_lazy_run(mp_obj_t , mp_obj_t );
+mp_obj_t evaluate_lazy_function(mp_float_t (*)(mp_float_t), mp_obj_t , mp_obj_t );
+mp_obj_t evaluate_lazy_reduce(mp_obj_t , uint8_t );
+
+// Copies n elements of type type, which are stride bytes apart, as mp_float_t into dest;
+// a is the current element, and value is the expression that converts it
+#define EVALUATE_COPY(type, source, stride, n, dest, value) do {\
+    uint8_t *_s = (source);\
+    for(size_t _i=0; _i < (n); _i++, _s += (stride)) {\
+        type a = *(type *)_s;\
+        (dest)[_i] = (value);\
+    }\
+} while(0)
+
+// Pops the block on the top of the stack, and replaces the new top by the result of op
+#define EVALUATE_BINARY(top, n, op) do {\
+    mp_float_t *_b = (top);\
+    (top) -= ULAB_EVALUATE_BLOCK;\
+    for(size_t _i=0; _i < (n); _i++) {\
+        (top)[_i] = (top)[_i] op _b[_i];\
+    }\
+} while(0)
+
+#endif
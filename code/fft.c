@@ -19,59 +19,53 @@
 #include "ndarray.h"
 #include "fft.h"
 
-enum FFT_TYPE {
-    FFT_FFT,
-    FFT_IFFT,
-    FFT_SPECTRUM,
-};
-
 void fft_kernel(mp_float_t *real, mp_float_t *imag, int n, int isign) {
-    // This is basically a modification of four1 from Numerical Recipes
-    // The main difference is that this function takes two arrays, one 
-    // for the real, and one for the imaginary parts. 
-    int j, m, mmax, istep;
-    mp_float_t tempr, tempi;
-    mp_float_t wtemp, wr, wpr, wpi, wi, theta;
+    FFT_KERNEL(mp_float_t, real, imag, n, isign, MICROPY_FLOAT_C_FUN(sin), 1);
+}
+
+STATIC void fft_kernel_complex(mp_float_t *real, mp_float_t *imag, int n, int isign) {
+    // the version of fft_kernel for complex arrays, whose real, and imaginary parts are interleaved
+    FFT_KERNEL(mp_float_t, real, imag, n, isign, MICROPY_FLOAT_C_FUN(sin), 2);
+}
+
+STATIC void fft_kernel_float32(float *real, float *imag, int n, int isign) {
+    // the single-precision version of fft_kernel for float32 arrays on double-precision platforms
+    FFT_KERNEL(float, real, imag, n, isign, ULAB_FLOAT32_C_FUN(sin), 1);
+}
 
-    j = 0;
-    for(int i = 0; i < n; i++) {
-        if (j > i) {
-            SWAP(mp_float_t, real[i], real[j]);
-            SWAP(mp_float_t, imag[i], imag[j]);
+STATIC void fft_copy_input(ndarray_obj_t *out, ndarray_obj_t *in) {
+    // copies the elements of in into the dense float, or float32 array out
+    if(out->array->typecode == in->array->typecode) {
+        // By treating this case separately, we can save a bit of time.
+        // I don't know if it is worthwhile, though...
+        memcpy(out->items, in->items, in->bytes);
+    } else if(NDARRAY_IS_FLOAT32(out->array->typecode)) {
+        for(size_t i=0; i < in->len; i++) {
+            ((float *)out->items)[i] = (float)ndarray_get_float_value(in->items, in->array->typecode, i);
         }
-        m = n >> 1;
-        while (j >= m && m > 0) {
-            j -= m;
-            m >>= 1;
+    } else {
+        for(size_t i=0; i < in->len; i++) {
+            ((mp_float_t *)out->items)[i] = ndarray_get_float_value(in->items, in->array->typecode, i);
         }
-        j += m;
     }
+}
 
-    mmax = 1;
-    while (n > mmax) {
-        istep = mmax << 1;
-        theta = -2.0*isign*MP_PI/istep;
-        wtemp = MICROPY_FLOAT_C_FUN(sin)(0.5 * theta);
-        wpr = -2.0 * wtemp * wtemp;
-        wpi = MICROPY_FLOAT_C_FUN(sin)(theta);
-        wr = 1.0;
-        wi = 0.0;
-        for(m = 0; m < mmax; m++) {
-            for(int i = m; i < n; i += istep) {
-                j = i + mmax;
-                tempr = wr * real[j] - wi * imag[j];
-                tempi = wr * imag[j] + wi * real[j];
-                real[j] = real[i] - tempr;
-                imag[j] = imag[i] - tempi;
-                real[i] += tempr;
-                imag[i] += tempi;
-            }
-            wtemp = wr;
-            wr = wr*wpr - wi*wpi + wr;
-            wi = wi*wpr + wtemp*wpi + wi;
+STATIC mp_obj_t fft_complex(ndarray_obj_t *in, uint8_t type) {
+    // complex arrays are transformed in a single buffer, and the result is a complex array, 
+    // except for the spectrum, which is float
+    ndarray_obj_t *out = create_empty_ndarray(1, in->len, NDARRAY_COMPLEX);
+    memcpy(out->items, in->items, in->bytes);
+    mp_float_t *data = (mp_float_t *)out->items;
+    FFT_TRANSFORM(mp_float_t, data, data+1, 2, in->len, type, fft_kernel_complex, MICROPY_FLOAT_C_FUN(sqrt));
+    if(type == FFT_SPECTRUM) {
+        ndarray_obj_t *spectrum = create_empty_ndarray(1, in->len, NDARRAY_FLOAT);
+        mp_float_t *array = (mp_float_t *)spectrum->items;
+        for(size_t i=0; i < in->len; i++) {
+            array[i] = data[2*i];
         }
-        mmax = istep;
+        return MP_OBJ_FROM_PTR(spectrum);
     }
+    return MP_OBJ_FROM_PTR(out);
 }
 
 mp_obj_t fft_fft_ifft_spectrum(size_t n_args, mp_obj_t arg_re, mp_obj_t arg_im, uint8_t type) {
@@ -84,54 +78,43 @@ mp_obj_t fft_fft_ifft_spectrum(size_t n_args, mp_obj_t arg_re, mp_obj_t arg_im,
         }
     }
     // Check if input is of length of power of 2
-    ndarray_obj_t *re = MP_OBJ_TO_PTR(arg_re);
-    uint16_t len = re->array->len;
+    ndarray_obj_t *re = ndarray_contiguous(MP_OBJ_TO_PTR(arg_re));
+    uint16_t len = re->len;
     if((len & (len-1)) != 0) {
         mp_raise_ValueError("input array length must be power of 2");
     }
-    
-    ndarray_obj_t *out_re = create_new_ndarray(1, len, NDARRAY_FLOAT);
-    mp_float_t *data_re = (mp_float_t *)out_re->array->items;
-    
-    if(re->array->typecode == NDARRAY_FLOAT) { 
-        // By treating this case separately, we can save a bit of time.
-        // I don't know if it is worthwhile, though...
-        memcpy((mp_float_t *)out_re->array->items, (mp_float_t *)re->array->items, re->bytes);
-    } else {
-        for(size_t i=0; i < len; i++) {
-            data_re[i] = ndarray_get_float_value(re->array->items, re->array->typecode, i);
+    if(re->array->typecode == NDARRAY_COMPLEX) {
+        if(n_args == 2) {
+            mp_raise_ValueError("complex input must be supplied as a single array");
         }
+        return fft_complex(re, type);
     }
-    ndarray_obj_t *out_im = create_new_ndarray(1, len, NDARRAY_FLOAT);
-    mp_float_t *data_im = (mp_float_t *)out_im->array->items;
-
+    ndarray_obj_t *im = NULL;
     if(n_args == 2) {
-        ndarray_obj_t *im = MP_OBJ_TO_PTR(arg_im);
-        if (re->array->len != im->array->len) {
+        im = ndarray_contiguous(MP_OBJ_TO_PTR(arg_im));
+        if (re->len != im->len) {
             mp_raise_ValueError("real and imaginary parts must be of equal length");
         }
-        if(im->array->typecode == NDARRAY_FLOAT) {
-            memcpy((mp_float_t *)out_im->array->items, (mp_float_t *)im->array->items, im->bytes);
-        } else {
-            for(size_t i=0; i < len; i++) {
-                data_im[i] = ndarray_get_float_value(im->array->items, im->array->typecode, i);
-            }
-        }
     }
-    if((type == FFT_FFT) || (type == FFT_SPECTRUM)) {
-        fft_kernel(data_re, data_im, len, 1);
-        if(type == FFT_SPECTRUM) {
-            for(size_t i=0; i < len; i++) {
-                data_re[i] = MICROPY_FLOAT_C_FUN(sqrt)(data_re[i]*data_re[i] + data_im[i]*data_im[i]);
-            }
-        }
-    } else { // inverse transform
-        fft_kernel(data_re, data_im, len, -1);
-        // TODO: numpy accepts the norm keyword argument
-        for(size_t i=0; i < len; i++) {
-            data_re[i] /= len;
-            data_im[i] /= len;
-        }
+    // float32 data are transformed in single precision, and the results are float32, too
+    uint8_t typecode = NDARRAY_FLOAT;
+    if(NDARRAY_IS_FLOAT32(re->array->typecode) && ((im == NULL) || NDARRAY_IS_FLOAT32(im->array->typecode))) {
+        typecode = NDARRAY_FLOAT32;
+    }
+    ndarray_obj_t *out_re = create_empty_ndarray(1, len, typecode);
+    fft_copy_input(out_re, re);
+    ndarray_obj_t *out_im;
+    if(im != NULL) {
+        out_im = create_empty_ndarray(1, len, typecode);
+        fft_copy_input(out_im, im);
+    } else {
+        // the imaginary part of real input is 0
+        out_im = create_new_ndarray(1, len, typecode);
+    }
+    if(NDARRAY_IS_FLOAT32(typecode)) {
+        FFT_TRANSFORM(float, (float *)out_re->items, (float *)out_im->items, 1, len, type, fft_kernel_float32, ULAB_FLOAT32_C_FUN(sqrt));
+    } else {
+        FFT_TRANSFORM(mp_float_t, (mp_float_t *)out_re->items, (mp_float_t *)out_im->items, 1, len, type, fft_kernel, MICROPY_FLOAT_C_FUN(sqrt));
     }
     if(type == FFT_SPECTRUM) {
         return MP_OBJ_TO_PTR(out_re);
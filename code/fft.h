@@ -17,6 +17,82 @@
 
 #define SWAP(t, a, b) { t tmp = a; a = b; b = tmp; }
 
+enum FFT_TYPE {
+    FFT_FFT,
+    FFT_IFFT,
+    FFT_SPECTRUM,
+};
+
+// This is basically a modification of four1 from Numerical Recipes
+// The main difference is that this function takes two arrays, one 
+// for the real, and one for the imaginary parts. The arithmetic is 
+// carried out in type, and sin_fun is the sine function of that type. 
+// Consecutive elements are stride apart, so that the interleaved parts 
+// of a complex array can be transformed with real = data, imag = data + 1, and stride = 2
+#define FFT_KERNEL(type, real, imag, n, isign, sin_fun, stride) do {\
+    int j, m, mmax, istep;\
+    type tempr, tempi;\
+    type wtemp, wr, wpr, wpi, wi, theta;\
+    j = 0;\
+    for(int i = 0; i < (n); i++) {\
+        if (j > i) {\
+            SWAP(type, (real)[i*(stride)], (real)[j*(stride)]);\
+            SWAP(type, (imag)[i*(stride)], (imag)[j*(stride)]);\
+        }\
+        m = (n) >> 1;\
+        while (j >= m && m > 0) {\
+            j -= m;\
+            m >>= 1;\
+        }\
+        j += m;\
+    }\
+    mmax = 1;\
+    while ((n) > mmax) {\
+        istep = mmax << 1;\
+        theta = -2.0*(isign)*MP_PI/istep;\
+        wtemp = sin_fun(0.5 * theta);\
+        wpr = -2.0 * wtemp * wtemp;\
+        wpi = sin_fun(theta);\
+        wr = 1.0;\
+        wi = 0.0;\
+        for(m = 0; m < mmax; m++) {\
+            for(int i = m; i < (n); i += istep) {\
+                j = i + mmax;\
+                tempr = wr * (real)[j*(stride)] - wi * (imag)[j*(stride)];\
+                tempi = wr * (imag)[j*(stride)] + wi * (real)[j*(stride)];\
+                (real)[j*(stride)] = (real)[i*(stride)] - tempr;\
+                (imag)[j*(stride)] = (imag)[i*(stride)] - tempi;\
+                (real)[i*(stride)] += tempr;\
+                (imag)[i*(stride)] += tempi;\
+            }\
+            wtemp = wr;\
+            wr = wr*wpr - wi*wpi + wr;\
+            wi = wi*wpr + wtemp*wpi + wi;\
+        }\
+        mmax = istep;\
+    }\
+} while(0)
+
+// Runs the transform of the given FFT_TYPE in place on the real, and imaginary parts of type type 
+// at data_re, and data_im, whose elements are stride apart; the spectrum is written into data_re
+#define FFT_TRANSFORM(type, data_re, data_im, stride, len, fft_type, kernel, sqrt_fun) do {\
+    if(((fft_type) == FFT_FFT) || ((fft_type) == FFT_SPECTRUM)) {\
+        kernel((data_re), (data_im), (len), 1);\
+        if((fft_type) == FFT_SPECTRUM) {\
+            for(size_t i=0; i < (len); i++) {\
+                (data_re)[i*(stride)] = sqrt_fun((data_re)[i*(stride)]*(data_re)[i*(stride)] + (data_im)[i*(stride)]*(data_im)[i*(stride)]);\
+            }\
+        }\
+    } else { /* inverse transform */\
+        kernel((data_re), (data_im), (len), -1);\
+        /* TODO: numpy accepts the norm keyword argument */\
+        for(size_t i=0; i < (len); i++) {\
+            (data_re)[i*(stride)] /= (len);\
+            (data_im)[i*(stride)] /= (len);\
+        }\
+    }\
+} while(0)
+
 mp_obj_t fft_fft(size_t , const mp_obj_t *);
 mp_obj_t fft_ifft(size_t , const mp_obj_t *);
 mp_obj_t fft_spectrum(size_t , const mp_obj_t *);
@@ -16,57 +16,77 @@
 #include "py/misc.h"
 #include "linalg.h"
 
+STATIC size_t linalg_get_shape(mp_obj_tuple_t *tuple, size_t *shape) {
+    // fills shape with the lengths in tuple, aligned to the right, and padded with 1s, and returns 
+    // the number of elements; negative lengths, and shapes with too many elements are rejected
+    size_t len = 1;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        shape[i] = 1;
+    }
+    for(uint8_t i=0; i < tuple->len; i++) {
+        mp_int_t n = mp_obj_get_int(tuple->items[i]);
+        if(n < 0) {
+            mp_raise_ValueError("negative dimensions are not allowed");
+        }
+        if((n != 0) && (len > SIZE_MAX / (size_t)n)) {
+            mp_raise_ValueError("array is too big");
+        }
+        shape[ULAB_MAX_DIMS-tuple->len+i] = (size_t)n;
+        len *= (size_t)n;
+    }
+    return len;
+}
+
 mp_obj_t linalg_transpose(mp_obj_t self_in) {
     ndarray_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    // the size of a single item in the array
-    uint8_t _sizeof = mp_binary_get_size('@', self->array->typecode, NULL);
-    
-    // NOTE: 
-    // if the matrices are square, we can simply swap items, but 
-    // generic matrices can't be transposed in place, so we have to 
-    // declare a temporary variable
-    
     // NOTE: 
-    //  In the old matrix, the coordinate (m, n) is m*self->n + n
-    //  We have to assign this to the coordinate (n, m) in the new 
-    //  matrix, i.e., to n*self->m + m (since the new matrix has self->m columns)
-    
-    // one-dimensional arrays can be transposed by simply swapping the dimensions
-    if((self->m != 1) && (self->n != 1)) {
-        uint8_t *c = (uint8_t *)self->array->items;
-        // self->bytes is the size of the bytearray, irrespective of the typecode
-        uint8_t *tmp = m_new(uint8_t, self->bytes);
-        for(size_t m=0; m < self->m; m++) {
-            for(size_t n=0; n < self->n; n++) {
-                memcpy(tmp+_sizeof*(n*self->m + m), c+_sizeof*(m*self->n + n), _sizeof);
-            }
+    //  In the old matrix, the coordinate (m, n) is at m*strides[0] + n*strides[1]
+    //  In the transposed matrix, the coordinate (n, m) must point to the same element, 
+    //  so it is enough to swap the strides along with the dimensions: no data have to be moved
+    //  The same holds for more dimensions: the transpose reverses the order of the axes
+    if(self->ndim == 2) {
+        SWAP(size_t, ROWS(self), COLUMNS(self));
+        SWAP(int32_t, self->strides[ULAB_MAX_DIMS-2], self->strides[ULAB_MAX_DIMS-1]);
+    } else {
+        for(uint8_t i=0; i < self->ndim/2; i++) {
+            uint8_t first = ULAB_MAX_DIMS - self->ndim + i, last = ULAB_MAX_DIMS - 1 - i;
+            SWAP(size_t, self->shape[first], self->shape[last]);
+            SWAP(int32_t, self->strides[first], self->strides[last]);
         }
-        memcpy(self->array->items, tmp, self->bytes);
-        m_del(uint8_t, tmp, self->bytes);
-    } 
-    SWAP(size_t, self->m, self->n);
+    }
     return mp_const_none;
 }
 
 mp_obj_t linalg_reshape(mp_obj_t self_in, mp_obj_t shape) {
     ndarray_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    if(!MP_OBJ_IS_TYPE(shape, &mp_type_tuple) || (MP_OBJ_SMALL_INT_VALUE(mp_obj_len_maybe(shape)) != 2)) {
-        mp_raise_ValueError("shape must be a 2-tuple");
+    if(!MP_OBJ_IS_TYPE(shape, &mp_type_tuple)) {
+        mp_raise_ValueError("shape must be a tuple");
     }
-
-    mp_obj_iter_buf_t iter_buf;
-    mp_obj_t item, iterable = mp_getiter(shape, &iter_buf);
-    uint16_t m, n;
-    item = mp_iternext(iterable);
-    m = mp_obj_get_int(item);
-    item = mp_iternext(iterable);
-    n = mp_obj_get_int(item);
-    if(m*n != self->m*self->n) {
+    mp_obj_tuple_t *tuple = MP_OBJ_TO_PTR(shape);
+    if((tuple->len < 1) || (tuple->len > ULAB_MAX_DIMS)) {
+        mp_raise_ValueError("too many dimensions");
+    }
+    // the new shape is aligned to the right, and padded with 1s
+    size_t new_shape[ULAB_MAX_DIMS];
+    if(linalg_get_shape(tuple, new_shape) != self->len) {
         // TODO: the proper error message would be "cannot reshape array of size %d into shape (%d, %d)"
         mp_raise_ValueError("cannot reshape array (incompatible input/output shape)");
     }
-    self->m = m;
-    self->n = n;
+    if(!ndarray_is_dense(self)) {
+        // the elements of a strided view can't be re-arranged by changing the strides only, 
+        // so self will be detached from the original storage, and receives a dense copy
+        ndarray_obj_t *tmp = MP_OBJ_TO_PTR(ndarray_copy(self_in));
+        self->array = tmp->array;
+        self->items = tmp->items;
+    }
+    // a 1-tuple results in a row vector
+    self->ndim = (tuple->len < 2) ? 2 : tuple->len;
+    int32_t stride = 1;
+    for(uint8_t i=ULAB_MAX_DIMS; i > 0; i--) {
+        self->shape[i-1] = new_shape[i-1];
+        self->strides[i-1] = stride;
+        stride *= new_shape[i-1];
+    }
     return MP_OBJ_FROM_PTR(self);
 }
 
@@ -84,20 +104,26 @@ mp_obj_t linalg_size(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args)
     } else {
         ndarray_obj_t *ndarray = MP_OBJ_TO_PTR(args[0].u_obj);
         if(args[1].u_obj == mp_const_none) {
-            return mp_obj_new_int(ndarray->array->len);
+            return mp_obj_new_int(ndarray->len);
         } else if(mp_obj_is_int(args[1].u_obj)) {
             uint8_t ax = mp_obj_get_int(args[1].u_obj);
+            if(ndarray->ndim > 2) {
+                if(ax >= ndarray->ndim) {
+                    mp_raise_ValueError("tuple index out of range");
+                }
+                return mp_obj_new_int(ndarray->shape[ULAB_MAX_DIMS-ndarray->ndim+ax]);
+            }
             if(ax == 0) {
-                if(ndarray->m == 1) {
-                    return mp_obj_new_int(ndarray->n);
+                if(ROWS(ndarray) == 1) {
+                    return mp_obj_new_int(COLUMNS(ndarray));
                 } else {
-                    return mp_obj_new_int(ndarray->m);                    
+                    return mp_obj_new_int(ROWS(ndarray));                    
                 }
             } else if(ax == 1) {
-                if(ndarray->m == 1) {
+                if(ROWS(ndarray) == 1) {
                     mp_raise_ValueError("tuple index out of range");
                 } else {
-                    return mp_obj_new_int(ndarray->n);
+                    return mp_obj_new_int(COLUMNS(ndarray));
                 }
             } else {
                     mp_raise_ValueError("tuple index out of range");                
@@ -159,25 +185,26 @@ mp_obj_t linalg_inv(mp_obj_t o_in) {
     if(!MP_OBJ_IS_TYPE(o_in, &ulab_ndarray_type)) {
         mp_raise_TypeError("only ndarray objects can be inverted");
     }
-    if(o->m != o->n) {
+    if((o->ndim > 2) || (ROWS(o) != COLUMNS(o))) {
         mp_raise_ValueError("only square matrices can be inverted");
     }
-    ndarray_obj_t *inverted = create_new_ndarray(o->m, o->n, NDARRAY_FLOAT);
-    mp_float_t *data = (mp_float_t *)inverted->array->items;
+    o = ndarray_contiguous(o);
+    ndarray_obj_t *inverted = create_new_ndarray(ROWS(o), COLUMNS(o), NDARRAY_FLOAT);
+    mp_float_t *data = (mp_float_t *)inverted->items;
     mp_obj_t elem;
-    for(size_t m=0; m < o->m; m++) { // rows first
-        for(size_t n=0; n < o->n; n++) { // columns next
+    for(size_t m=0; m < ROWS(o); m++) { // rows first
+        for(size_t n=0; n < COLUMNS(o); n++) { // columns next
             // this could, perhaps, be done in single line... 
             // On the other hand, we probably spend little time here
-            elem = mp_binary_get_val_array(o->array->typecode, o->array->items, m*o->n+n);
-            data[m*o->n+n] = (mp_float_t)mp_obj_get_float(elem);
+            elem = ndarray_get_value(o->array->typecode, o->items, m*COLUMNS(o)+n);
+            data[m*COLUMNS(o)+n] = (mp_float_t)mp_obj_get_float(elem);
         }
     }
     
-    if(!linalg_invert_matrix(data, o->m)) {
+    if(!linalg_invert_matrix(data, ROWS(o))) {
         // TODO: I am not sure this is needed here. Otherwise, 
         // how should we free up the unused RAM of inverted?
-        m_del(mp_float_t, inverted->array->items, o->n*o->n);
+        m_del(mp_float_t, inverted->items, COLUMNS(o)*COLUMNS(o));
         mp_raise_ValueError("input matrix is singular");
     }
     return MP_OBJ_FROM_PTR(inverted);
@@ -185,31 +212,32 @@ mp_obj_t linalg_inv(mp_obj_t o_in) {
 
 mp_obj_t linalg_dot(mp_obj_t _m1, mp_obj_t _m2) {
     // TODO: should the results be upcast?
-    ndarray_obj_t *m1 = MP_OBJ_TO_PTR(_m1);
-    ndarray_obj_t *m2 = MP_OBJ_TO_PTR(_m2);    
-    if(m1->n != m2->m) {
+    ndarray_obj_t *m1 = ndarray_contiguous(MP_OBJ_TO_PTR(_m1));
+    ndarray_obj_t *m2 = ndarray_contiguous(MP_OBJ_TO_PTR(_m2));
+    if((m1->ndim > 2) || (m2->ndim > 2) || (COLUMNS(m1) != ROWS(m2))) {
         mp_raise_ValueError("matrix dimensions do not match");
     }
     // TODO: numpy uses upcasting here
-    ndarray_obj_t *out = create_new_ndarray(m1->m, m2->n, NDARRAY_FLOAT);
-    mp_float_t *outdata = (mp_float_t *)out->array->items;
+    ndarray_obj_t *out = create_new_ndarray(ROWS(m1), COLUMNS(m2), NDARRAY_FLOAT);
+    mp_float_t *outdata = (mp_float_t *)out->items;
     mp_float_t sum, v1, v2;
-    for(size_t i=0; i < m1->n; i++) {
-        for(size_t j=0; j < m2->m; j++) {
+    for(size_t i=0; i < COLUMNS(m1); i++) {
+        for(size_t j=0; j < ROWS(m2); j++) {
             sum = 0.0;
-            for(size_t k=0; k < m1->m; k++) {
+            for(size_t k=0; k < ROWS(m1); k++) {
                 // (i, k) * (k, j)
-                v1 = ndarray_get_float_value(m1->array->items, m1->array->typecode, i*m1->n+k);
-                v2 = ndarray_get_float_value(m2->array->items, m2->array->typecode, k*m2->n+j);
+                v1 = ndarray_get_float_value(m1->items, m1->array->typecode, i*COLUMNS(m1)+k);
+                v2 = ndarray_get_float_value(m2->items, m2->array->typecode, k*COLUMNS(m2)+j);
                 sum += v1 * v2;
             }
-            outdata[i*m1->m+j] = sum;
+            outdata[i*ROWS(m1)+j] = sum;
         }
     }
     return MP_OBJ_FROM_PTR(out);
 }
 
 mp_obj_t linalg_zeros_ones(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args, uint8_t kind) {
+    // kind is 0 for zeros, 1 for ones, and 2 for empty, whose elements are not initialised
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} } ,
         { MP_QSTR_dtype, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = NDARRAY_FLOAT} },
@@ -220,24 +248,29 @@ mp_obj_t linalg_zeros_ones(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw
     
     uint8_t dtype = args[1].u_int;
     if(!mp_obj_is_int(args[0].u_obj) && !mp_obj_is_type(args[0].u_obj, &mp_type_tuple)) {
-        mp_raise_TypeError("input argument must be an integer or a 2-tuple");
+        mp_raise_TypeError("input argument must be an integer or a tuple");
     }
     ndarray_obj_t *ndarray = NULL;
     if(mp_obj_is_int(args[0].u_obj)) {
-        size_t n = mp_obj_get_int(args[0].u_obj);
-        ndarray = create_new_ndarray(1, n, dtype);
+        mp_int_t n = mp_obj_get_int(args[0].u_obj);
+        if(n < 0) {
+            mp_raise_ValueError("negative dimensions are not allowed");
+        }
+        ndarray = (kind == 0) ? create_new_ndarray(1, n, dtype) : create_empty_ndarray(1, n, dtype);
     } else if(mp_obj_is_type(args[0].u_obj, &mp_type_tuple)) {
         mp_obj_tuple_t *tuple = MP_OBJ_TO_PTR(args[0].u_obj);
-        if(tuple->len != 2) {
-            mp_raise_TypeError("input argument must be an integer or a 2-tuple");            
+        if((tuple->len < 1) || (tuple->len > ULAB_MAX_DIMS)) {
+            mp_raise_TypeError("input argument must be an integer or a tuple of at most 4 integers");            
         }
-        ndarray = create_new_ndarray(mp_obj_get_int(tuple->items[0]), 
-                                                  mp_obj_get_int(tuple->items[1]), dtype);
+        size_t shape[ULAB_MAX_DIMS];
+        linalg_get_shape(tuple, shape);
+        uint8_t ndim = (tuple->len < 2) ? 2 : tuple->len;
+        ndarray = (kind == 0) ? ndarray_new_ndarray(ndim, shape, dtype) : ndarray_new_empty(ndim, shape, dtype);
     }
     if(kind == 1) {
         mp_obj_t one = mp_obj_new_int(1);
-        for(size_t i=0; i < ndarray->array->len; i++) {
-            mp_binary_set_val_array(dtype, ndarray->array->items, i, one);
+        for(size_t i=0; i < ndarray->len; i++) {
+            ndarray_set_value(ndarray->array->typecode, ndarray->items, i, one);
         }
     }
     return MP_OBJ_FROM_PTR(ndarray);
@@ -251,6 +284,10 @@ mp_obj_t linalg_ones(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args)
     return linalg_zeros_ones(n_args, pos_args, kw_args, 1);
 }
 
+mp_obj_t linalg_empty(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return linalg_zeros_ones(n_args, pos_args, kw_args, 2);
+}
+
 mp_obj_t linalg_eye(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0} },
@@ -276,7 +313,7 @@ mp_obj_t linalg_eye(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args)
     size_t i = 0;
     if((k >= 0) && (k < n)) {
         while(k < n) {
-            mp_binary_set_val_array(dtype, ndarray->array->items, i*n+k, one);
+            ndarray_set_value(ndarray->array->typecode, ndarray->items, i*n+k, one);
             k++;
             i++;
         }
@@ -284,7 +321,7 @@ mp_obj_t linalg_eye(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args)
         k = -k;
         i = 0;
         while(k < m) {
-            mp_binary_set_val_array(dtype, ndarray->array->items, k*n+i, one);
+            ndarray_set_value(ndarray->array->typecode, ndarray->items, k*n+i, one);
             k++;
             i++;
         }
@@ -296,36 +333,36 @@ mp_obj_t linalg_det(mp_obj_t oin) {
     if(!mp_obj_is_type(oin, &ulab_ndarray_type)) {
         mp_raise_TypeError("function defined for ndarrays only");
     }
-    ndarray_obj_t *in = MP_OBJ_TO_PTR(oin);
-    if(in->m != in->n) {
+    ndarray_obj_t *in = ndarray_contiguous(MP_OBJ_TO_PTR(oin));
+    if((in->ndim > 2) || (ROWS(in) != COLUMNS(in))) {
         mp_raise_ValueError("input must be square matrix");
     }
     
-    mp_float_t *tmp = m_new(mp_float_t, in->n*in->n);
-    for(size_t i=0; i < in->array->len; i++){
-        tmp[i] = ndarray_get_float_value(in->array->items, in->array->typecode, i);
+    mp_float_t *tmp = m_new(mp_float_t, COLUMNS(in)*COLUMNS(in));
+    for(size_t i=0; i < in->len; i++){
+        tmp[i] = ndarray_get_float_value(in->items, in->array->typecode, i);
     }
     mp_float_t c;
-    for(size_t m=0; m < in->m-1; m++){
-        if(fabs(tmp[m*(in->n+1)]) < epsilon) {
-            m_del(mp_float_t, tmp, in->n*in->n);
+    for(size_t m=0; m < ROWS(in)-1; m++){
+        if(fabs(tmp[m*(COLUMNS(in)+1)]) < epsilon) {
+            m_del(mp_float_t, tmp, COLUMNS(in)*COLUMNS(in));
             return mp_obj_new_float(0.0);
         }
-        for(size_t n=0; n < in->n; n++){
+        for(size_t n=0; n < COLUMNS(in); n++){
             if(m != n) {
-                c = tmp[in->n*n+m] / tmp[m*(in->n+1)];
-                for(size_t k=0; k < in->n; k++){
-                    tmp[in->n*n+k] -= c * tmp[in->n*m+k];
+                c = tmp[COLUMNS(in)*n+m] / tmp[m*(COLUMNS(in)+1)];
+                for(size_t k=0; k < COLUMNS(in); k++){
+                    tmp[COLUMNS(in)*n+k] -= c * tmp[COLUMNS(in)*m+k];
                 }
             }
         }
     }
     mp_float_t det = 1.0;
                             
-    for(size_t m=0; m < in->m; m++){ 
-        det *= tmp[m*(in->n+1)];
+    for(size_t m=0; m < ROWS(in); m++){ 
+        det *= tmp[m*(COLUMNS(in)+1)];
     }
-    m_del(mp_float_t, tmp, in->n*in->n);
+    m_del(mp_float_t, tmp, COLUMNS(in)*COLUMNS(in));
     return mp_obj_new_float(det);
 }
 
@@ -333,20 +370,20 @@ mp_obj_t linalg_eig(mp_obj_t oin) {
     if(!mp_obj_is_type(oin, &ulab_ndarray_type)) {
         mp_raise_TypeError("function defined for ndarrays only");
     }
-    ndarray_obj_t *in = MP_OBJ_TO_PTR(oin);
-    if(in->m != in->n) {
+    ndarray_obj_t *in = ndarray_contiguous(MP_OBJ_TO_PTR(oin));
+    if((in->ndim > 2) || (ROWS(in) != COLUMNS(in))) {
         mp_raise_ValueError("input must be square matrix");
     }
-    mp_float_t *array = m_new(mp_float_t, in->array->len);
-    for(size_t i=0; i < in->array->len; i++) {
-        array[i] = ndarray_get_float_value(in->array->items, in->array->typecode, i);
+    mp_float_t *array = m_new(mp_float_t, in->len);
+    for(size_t i=0; i < in->len; i++) {
+        array[i] = ndarray_get_float_value(in->items, in->array->typecode, i);
     }
     // make sure the matrix is symmetric
-    for(size_t m=0; m < in->m; m++) {
-        for(size_t n=m+1; n < in->n; n++) {
+    for(size_t m=0; m < ROWS(in); m++) {
+        for(size_t n=m+1; n < COLUMNS(in); n++) {
             // compare entry (m, n) to (n, m)
             // TODO: this must probably be scaled!
-            if(epsilon < fabs(array[m*in->n + n] - array[n*in->n + m])) {
+            if(epsilon < fabs(array[m*COLUMNS(in) + n] - array[n*COLUMNS(in) + m])) {
                 mp_raise_ValueError("input matrix is asymmetric");
             }
         }
@@ -354,24 +391,24 @@ mp_obj_t linalg_eig(mp_obj_t oin) {
     
     // if we got this far, then the matrix will be symmetric
     
-    ndarray_obj_t *eigenvectors = create_new_ndarray(in->m, in->n, NDARRAY_FLOAT);
-    mp_float_t *eigvectors = (mp_float_t *)eigenvectors->array->items;
+    ndarray_obj_t *eigenvectors = create_new_ndarray(ROWS(in), COLUMNS(in), NDARRAY_FLOAT);
+    mp_float_t *eigvectors = (mp_float_t *)eigenvectors->items;
     // start out with the unit matrix
-    for(size_t m=0; m < in->m; m++) {
-        eigvectors[m*(in->n+1)] = 1.0;
+    for(size_t m=0; m < ROWS(in); m++) {
+        eigvectors[m*(COLUMNS(in)+1)] = 1.0;
     }
     mp_float_t largest, w, t, c, s, tau, aMk, aNk, vm, vn;
     size_t M, N;
-    size_t iterations = JACOBI_MAX*in->n*in->n;
+    size_t iterations = JACOBI_MAX*COLUMNS(in)*COLUMNS(in);
     do {
         iterations--;
         // find the pivot here
         M = 0;
         N = 0;
         largest = 0.0;
-        for(size_t m=0; m < in->m-1; m++) { // -1: no need to inspect last row
-            for(size_t n=m+1; n < in->n; n++) {
-                w = fabs(array[m*in->n + n]);
+        for(size_t m=0; m < ROWS(in)-1; m++) { // -1: no need to inspect last row
+            for(size_t n=m+1; n < COLUMNS(in); n++) {
+                w = fabs(array[m*COLUMNS(in) + n]);
                 if((largest < w) && (epsilon < w)) {
                     M = m;
                     N = n;
@@ -384,7 +421,7 @@ mp_obj_t linalg_eig(mp_obj_t oin) {
         }
         // at this point, we have the pivot, and it is the entry (M, N)
         // now we have to find the rotation angle
-        w = (array[N*in->n + N] - array[M*in->n + M]) / (2.0*array[M*in->n + N]);
+        w = (array[N*COLUMNS(in) + N] - array[M*COLUMNS(in) + M]) / (2.0*array[M*COLUMNS(in) + N]);
         // The following if/else chooses the smaller absolute value for the tangent 
         // of the rotation angle. Going with the smaller should be numerically stabler.
         if(w > 0) {
@@ -399,26 +436,26 @@ mp_obj_t linalg_eig(mp_obj_t oin) {
         // at this point, we have the rotation angles, so we can transform the matrix
         // first the two diagonal elements
         // a(M, M) = a(M, M) - t*a(M, N)
-        array[M*in->n + M] = array[M*in->n + M] - t * array[M*in->n + N];
+        array[M*COLUMNS(in) + M] = array[M*COLUMNS(in) + M] - t * array[M*COLUMNS(in) + N];
         // a(N, N) = a(N, N) + t*a(M, N)
-        array[N*in->n + N] = array[N*in->n + N] + t * array[M*in->n + N];
+        array[N*COLUMNS(in) + N] = array[N*COLUMNS(in) + N] + t * array[M*COLUMNS(in) + N];
         // after the rotation, the a(M, N), and a(N, M) entries should become zero
-        array[M*in->n + N] = array[N*in->n + M] = 0.0;
+        array[M*COLUMNS(in) + N] = array[N*COLUMNS(in) + M] = 0.0;
         // then all other elements in the column
-        for(size_t k=0; k < in->m; k++) {
+        for(size_t k=0; k < ROWS(in); k++) {
             if((k == M) || (k == N)) {
                 continue;
             }
-            aMk = array[M*in->n + k];
-            aNk = array[N*in->n + k];
+            aMk = array[M*COLUMNS(in) + k];
+            aNk = array[N*COLUMNS(in) + k];
             // a(M, k) = a(M, k) - s*(a(N, k) + tau*a(M, k))
-            array[M*in->n + k] -= s*(aNk + tau*aMk);
+            array[M*COLUMNS(in) + k] -= s*(aNk + tau*aMk);
             // a(N, k) = a(N, k) + s*(a(M, k) - tau*a(N, k))
-            array[N*in->n + k] += s*(aMk - tau*aNk);
+            array[N*COLUMNS(in) + k] += s*(aMk - tau*aNk);
             // a(k, M) = a(M, k)
-            array[k*in->n + M] = array[M*in->n + k];
+            array[k*COLUMNS(in) + M] = array[M*COLUMNS(in) + k];
             // a(k, N) = a(N, k)
-            array[k*in->n + N] = array[N*in->n + k];
+            array[k*COLUMNS(in) + N] = array[N*COLUMNS(in) + k];
         }
         // now we have to update the eigenvectors
         // the rotation matrix, R, multiplies from the right
@@ -427,27 +464,27 @@ mp_obj_t linalg_eig(mp_obj_t oin) {
         // R(N, M) = s
         // (M, N) = -s
         // entries. This means that only the Mth, and Nth columns will change
-        for(size_t m=0; m < in->m; m++) {
-            vm = eigvectors[m*in->n+M];
-            vn = eigvectors[m*in->n+N];
+        for(size_t m=0; m < ROWS(in); m++) {
+            vm = eigvectors[m*COLUMNS(in)+M];
+            vn = eigvectors[m*COLUMNS(in)+N];
             // the new value of eigvectors(m, M)
-            eigvectors[m*in->n+M] = c * vm - s * vn;
+            eigvectors[m*COLUMNS(in)+M] = c * vm - s * vn;
             // the new value of eigvectors(m, N)
-            eigvectors[m*in->n+N] = s * vm + c * vn;
+            eigvectors[m*COLUMNS(in)+N] = s * vm + c * vn;
         }
     } while(iterations > 0);
     
     if(iterations == 0) { 
         // the computation did not converge; numpy raises LinAlgError
-        m_del(mp_float_t, array, in->array->len);
+        m_del(mp_float_t, array, in->len);
         mp_raise_ValueError("iterations did not converge");
     }
-    ndarray_obj_t *eigenvalues = create_new_ndarray(1, in->n, NDARRAY_FLOAT);
-    mp_float_t *eigvalues = (mp_float_t *)eigenvalues->array->items;
-    for(size_t i=0; i < in->n; i++) {
-        eigvalues[i] = array[i*(in->n+1)];
+    ndarray_obj_t *eigenvalues = create_new_ndarray(1, COLUMNS(in), NDARRAY_FLOAT);
+    mp_float_t *eigvalues = (mp_float_t *)eigenvalues->items;
+    for(size_t i=0; i < COLUMNS(in); i++) {
+        eigvalues[i] = array[i*(COLUMNS(in)+1)];
     }
-    m_del(mp_float_t, array, in->array->len);
+    m_del(mp_float_t, array, in->len);
     
     mp_obj_tuple_t *tuple = MP_OBJ_TO_PTR(mp_obj_new_tuple(2, NULL));
     tuple->items[0] = MP_OBJ_FROM_PTR(eigenvalues);
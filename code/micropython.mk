@@ -8,6 +8,7 @@ SRC_USERMOD += $(USERMODULES_DIR)/vectorise.c
 SRC_USERMOD += $(USERMODULES_DIR)/poly.c
 SRC_USERMOD += $(USERMODULES_DIR)/fft.c
 SRC_USERMOD += $(USERMODULES_DIR)/numerical.c
+SRC_USERMOD += $(USERMODULES_DIR)/evaluate.c
 SRC_USERMOD += $(USERMODULES_DIR)/ulab.c
 
 # We can add our module folder to include paths if needed
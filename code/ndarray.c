@@ -17,10 +17,12 @@
 #include "py/obj.h"
 #include "py/objtuple.h"
 #include "ndarray.h"
+#include "evaluate.h"
 
-// This function is copied verbatim from objarray.c
+// This function is copied from objarray.c; the element size is taken from ndarray_itemsize, 
+// because micropython doesn't know the float16 typecode
 STATIC mp_obj_array_t *array_new(char typecode, size_t n) {
-    int typecode_size = mp_binary_get_size('@', typecode, NULL);
+    int typecode_size = ndarray_itemsize(typecode);
     mp_obj_array_t *o = m_new_obj(mp_obj_array_t);
     // this step could probably be skipped: we are never going to store a bytearray per se
     #if MICROPY_PY_BUILTINS_BYTEARRAY && MICROPY_PY_ARRAY
@@ -37,6 +39,66 @@ STATIC mp_obj_array_t *array_new(char typecode, size_t n) {
     return o;
 }
 
+size_t ndarray_itemsize(uint8_t typecode) {
+    // the size of a single element in bytes
+    if(typecode == NDARRAY_FLOAT16) {
+        return 2;
+    } else if(typecode == NDARRAY_COMPLEX) {
+        return 2 * sizeof(mp_float_t);
+    }
+    return mp_binary_get_size('@', typecode, NULL);
+}
+
+mp_float_t ndarray_float16_to_float(uint16_t half) {
+    // converts the bits of an IEEE 754 half-precision float to mp_float_t
+    uint16_t exponent = (half >> 10) & 0x1f;
+    uint16_t mantissa = half & 0x3ff;
+    mp_float_t value;
+    if(exponent == 0x1f) { // infinity, or nan
+        value = (mantissa == 0) ? (mp_float_t)INFINITY : (mp_float_t)NAN;
+    } else if(exponent == 0) { // zero, or subnormal: mantissa * 2^-24
+        value = MICROPY_FLOAT_C_FUN(ldexp)((mp_float_t)mantissa, -24);
+    } else {
+        value = MICROPY_FLOAT_C_FUN(ldexp)((mp_float_t)(mantissa | 0x400), exponent - 25);
+    }
+    return (half & 0x8000) ? -value : value;
+}
+
+uint16_t ndarray_float_to_float16(mp_float_t value) {
+    // converts value to the bits of an IEEE 754 half-precision float; the value is rounded to 
+    // the nearest representable number (ties to even), and overflows result in infinity
+    union { float f; uint32_t i; } bits;
+    bits.f = (float)value;
+    uint16_t sign = (bits.i >> 16) & 0x8000;
+    uint32_t mantissa = bits.i & 0x7fffff;
+    if(((bits.i >> 23) & 0xff) == 0xff) { // infinity, or nan
+        return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+    }
+    // the exponent is re-biased from 127 to 15
+    int32_t exponent = (int32_t)((bits.i >> 23) & 0xff) - 127 + 15;
+    if(exponent >= 0x1f) {
+        return sign | 0x7c00;
+    }
+    uint8_t shift = 13;
+    if(exponent <= 0) {
+        // the result is subnormal, or zero: the implicit leading bit is shifted into the mantissa
+        if(exponent < -10) {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        shift = 14 - exponent;
+        exponent = 0;
+    }
+    uint32_t half = ((uint32_t)exponent << 10) | (mantissa >> shift);
+    uint32_t remainder = mantissa & ((1UL << shift) - 1);
+    uint32_t midpoint = 1UL << (shift - 1);
+    if((remainder > midpoint) || ((remainder == midpoint) && (half & 1))) {
+        // a carry into the exponent is correct, even if it results in infinity
+        half++;
+    }
+    return sign | (uint16_t)half;
+}
+
 mp_float_t ndarray_get_float_value(void *data, uint8_t typecode, size_t index) {
     if(typecode == NDARRAY_UINT8) {
         return (mp_float_t)((uint8_t *)data)[index];
@@ -46,11 +108,119 @@ mp_float_t ndarray_get_float_value(void *data, uint8_t typecode, size_t index) {
         return (mp_float_t)((uint16_t *)data)[index];
     } else if(typecode == NDARRAY_INT16) {
         return (mp_float_t)((int16_t *)data)[index];
+    } else if(typecode == NDARRAY_UINT32) {
+        return (mp_float_t)((uint32_t *)data)[index];
+    } else if(typecode == NDARRAY_INT32) {
+        return (mp_float_t)((int32_t *)data)[index];
+    } else if(NDARRAY_IS_FLOAT32(typecode)) {
+        return (mp_float_t)((float *)data)[index];
+    } else if(typecode == NDARRAY_FLOAT16) {
+        return ndarray_float16_to_float(((uint16_t *)data)[index]);
+    } else if(typecode == NDARRAY_COMPLEX) {
+        mp_raise_TypeError("can't convert complex to float");
     } else {
         return (mp_float_t)((mp_float_t *)data)[index];
     }
 }
 
+void ndarray_set_float_value(void *data, uint8_t typecode, size_t index, mp_float_t value) {
+    // the counterpart of ndarray_get_float_value for the float types
+    if(typecode == NDARRAY_FLOAT16) {
+        ((uint16_t *)data)[index] = ndarray_float_to_float16(value);
+    } else if(NDARRAY_IS_FLOAT32(typecode)) {
+        ((float *)data)[index] = (float)value;
+    } else if(typecode == NDARRAY_COMPLEX) {
+        ((mp_float_t *)data)[2*index] = value;
+        ((mp_float_t *)data)[2*index+1] = MICROPY_FLOAT_CONST(0.0);
+    } else {
+        ((mp_float_t *)data)[index] = value;
+    }
+}
+
+void ndarray_get_complex_value(void *data, uint8_t typecode, size_t index, mp_float_t *real, mp_float_t *imag) {
+    // reads the element at index as a complex number; the imaginary part of real types is 0
+    if(typecode == NDARRAY_COMPLEX) {
+        *real = ((mp_float_t *)data)[2*index];
+        *imag = ((mp_float_t *)data)[2*index+1];
+    } else {
+        *real = ndarray_get_float_value(data, typecode, index);
+        *imag = MICROPY_FLOAT_CONST(0.0);
+    }
+}
+
+void ndarray_check_real(ndarray_obj_t *ndarray) {
+    // raises a TypeError in functions that are defined for real numbers only
+    if(ndarray->array->typecode == NDARRAY_COMPLEX) {
+        mp_raise_TypeError("function is not implemented for complex arrays");
+    }
+}
+
+mp_obj_t ndarray_get_value(uint8_t typecode, void *items, size_t index) {
+    // returns the element at index as a micropython object
+    if(typecode == NDARRAY_FLOAT16) {
+        return mp_obj_new_float(ndarray_float16_to_float(((uint16_t *)items)[index]));
+    }
+    #if ULAB_HAS_COMPLEX
+    if(typecode == NDARRAY_COMPLEX) {
+        return mp_obj_new_complex(((mp_float_t *)items)[2*index], ((mp_float_t *)items)[2*index+1]);
+    }
+    #endif
+    return mp_binary_get_val_array(typecode, items, index);
+}
+
+mp_float_t ndarray_round_nearest(mp_float_t x) {
+    // floats are converted to integers by rounding them to the nearest integer everywhere 
+    // (array, astype, assignments, and vectorize); halves are rounded upwards
+    // workaround: rounding seems not to work in the arm compiler
+    return MICROPY_FLOAT_C_FUN(floor)(x + MICROPY_FLOAT_CONST(0.5));
+}
+
+int64_t ndarray_float_to_integer(mp_float_t value, mp_float_t (*round_fun)(mp_float_t), bool saturate, int64_t min, int64_t max) {
+    value = round_fun(value);
+    if(value != value) { // nan
+        return 0;
+    }
+    if(saturate) {
+        if(value < min) {
+            return min;
+        }
+        if(value > max) {
+            return max;
+        }
+    }
+    if((value < (mp_float_t)INT64_MIN) || (value >= -(mp_float_t)INT64_MIN)) {
+        // infinities, and values beyond the range of int64 can't be cast, and are converted to 0
+        return 0;
+    }
+    return (int64_t)value;
+}
+
+void ndarray_set_value(uint8_t typecode, void *items, size_t index, mp_obj_t value) {
+    // converts the micropython object value, and writes it to items at index
+    if(typecode == NDARRAY_FLOAT16) {
+        ((uint16_t *)items)[index] = ndarray_float_to_float16(mp_obj_get_float(value));
+    #if ULAB_HAS_COMPLEX
+    } else if(typecode == NDARRAY_COMPLEX) {
+        mp_obj_get_complex(value, &((mp_float_t *)items)[2*index], &((mp_float_t *)items)[2*index+1]);
+    #endif
+    } else if(mp_obj_is_float(value) && !NDARRAY_IS_FLOAT(typecode)) {
+        // a float written into an integer array is rounded, as in ndarray_set_binary_value; 
+        // it is not truncated to int32, so that values up to 2^32-1 reach uint32 arrays intact
+        mp_binary_set_val_array_from_int(typecode, items, index, 
+                                         (mp_int_t)ndarray_float_to_integer(mp_obj_get_float(value), ndarray_round_nearest, false, 0, 0));
+    } else {
+        mp_binary_set_val_array(typecode, items, index, value);
+    }
+}
+
+mp_obj_t ndarray_get_item(ndarray_obj_t *ndarray, void *item) {
+    // returns the element at item as a micropython object
+    if(ndarray->boolean) {
+        return mp_obj_new_bool(*(uint8_t *)item);
+    }
+    return ndarray_get_value(ndarray->array->typecode, item, 0);
+}
+
 void fill_array_iterable(mp_float_t *array, mp_obj_t iterable) {
     mp_obj_iter_buf_t x_buf;
     mp_obj_t x_item, x_iterable = mp_getiter(iterable, &x_buf);
@@ -61,27 +231,52 @@ void fill_array_iterable(mp_float_t *array, mp_obj_t iterable) {
     }
 }
 
-void ndarray_print_row(const mp_print_t *print, mp_obj_array_t *data, size_t n0, size_t n) {
+void ndarray_print_row(const mp_print_t *print, ndarray_obj_t *ndarray, uint8_t *row, size_t n, int32_t stride) {
+    // prints n elements starting at row; stride is the distance between consecutive elements in bytes
     mp_print_str(print, "[");
     size_t i;
     if(n < PRINT_MAX) { // if the array is short, print everything
-        mp_obj_print_helper(print, mp_binary_get_val_array(data->typecode, data->items, n0), PRINT_REPR);
+        mp_obj_print_helper(print, ndarray_get_item(ndarray, row), PRINT_REPR);
         for(i=1; i<n; i++) {
             mp_print_str(print, ", ");
-            mp_obj_print_helper(print, mp_binary_get_val_array(data->typecode, data->items, n0+i), PRINT_REPR);
+            mp_obj_print_helper(print, ndarray_get_item(ndarray, row+(int32_t)i*stride), PRINT_REPR);
         }
     } else {
-        mp_obj_print_helper(print, mp_binary_get_val_array(data->typecode, data->items, n0), PRINT_REPR);
+        mp_obj_print_helper(print, ndarray_get_item(ndarray, row), PRINT_REPR);
         for(i=1; i<3; i++) {
             mp_print_str(print, ", ");
-            mp_obj_print_helper(print, mp_binary_get_val_array(data->typecode, data->items, n0+i), PRINT_REPR);
+            mp_obj_print_helper(print, ndarray_get_item(ndarray, row+(int32_t)i*stride), PRINT_REPR);
         }
         mp_printf(print, ", ..., ");
-        mp_obj_print_helper(print, mp_binary_get_val_array(data->typecode, data->items, n0+n-3), PRINT_REPR);
+        mp_obj_print_helper(print, ndarray_get_item(ndarray, row+(int32_t)(n-3)*stride), PRINT_REPR);
         for(size_t i=1; i<3; i++) {
             mp_print_str(print, ", ");
-            mp_obj_print_helper(print, mp_binary_get_val_array(data->typecode, data->items, n0+n-3+i), PRINT_REPR);
+            mp_obj_print_helper(print, ndarray_get_item(ndarray, row+(int32_t)(n-3+i)*stride), PRINT_REPR);
+        }
+    }
+    mp_print_str(print, "]");
+}
+
+STATIC void ndarray_print_axis(const mp_print_t *print, ndarray_obj_t *self, uint8_t *items, uint8_t axis) {
+    // prints the sub-array starting at items along axis, and all axes after that
+    uint8_t _sizeof = ndarray_itemsize(self->array->typecode);
+    if(axis == ULAB_MAX_DIMS-1) {
+        ndarray_print_row(print, self, items, self->shape[axis], self->strides[axis]*_sizeof);
+        return;
+    }
+    // TODO: add vertical ellipses for the case, when self->shape[axis] > PRINT_MAX
+    mp_print_str(print, "[");
+    for(size_t i=0; i < self->shape[axis]; i++) {
+        if(i > 0) {
+            // the blocks of higher dimensional arrays are separated by an increasing number of empty lines
+            mp_print_str(print, ",");
+            for(uint8_t k=axis; k < ULAB_MAX_DIMS-1; k++) {
+                mp_print_str(print, "\n");
+            }
+            mp_print_str(print, "\t ");
         }
+        ndarray_print_axis(print, self, items, axis+1);
+        items += self->strides[axis]*_sizeof;
     }
     mp_print_str(print, "]");
 }
@@ -89,25 +284,22 @@ void ndarray_print_row(const mp_print_t *print, mp_obj_array_t *data, size_t n0,
 void ndarray_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
     (void)kind;
     ndarray_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    uint8_t _sizeof = ndarray_itemsize(self->array->typecode);
+    uint8_t *items = (uint8_t *)self->items;
     mp_print_str(print, "array(");
     
-    if(self->array->len == 0) {
+    if(self->len == 0) {
         mp_print_str(print, "[]");
+    } else if((self->ndim == 2) && (ROWS(self) == 1)) {
+        ndarray_print_row(print, self, items, COLUMNS(self), self->strides[ULAB_MAX_DIMS-1]*_sizeof);
+    } else if((self->ndim == 2) && (COLUMNS(self) == 1)) {
+        ndarray_print_row(print, self, items, ROWS(self), self->strides[ULAB_MAX_DIMS-2]*_sizeof);
     } else {
-        if((self->m == 1) || (self->n == 1)) {
-            ndarray_print_row(print, self->array, 0, self->array->len);
-        } else {
-            // TODO: add vertical ellipses for the case, when self->m > PRINT_MAX
-            mp_print_str(print, "[");
-            ndarray_print_row(print, self->array, 0, self->n);
-            for(size_t i=1; i < self->m; i++) {
-                mp_print_str(print, ",\n\t ");
-                ndarray_print_row(print, self->array, i*self->n, self->n);
-            }
-            mp_print_str(print, "]");
-        }
+        ndarray_print_axis(print, self, items, ULAB_MAX_DIMS-self->ndim);
     }
-    if(self->array->typecode == NDARRAY_UINT8) {
+    if(self->boolean) {
+        mp_print_str(print, ", dtype=bool)");
+    } else if(self->array->typecode == NDARRAY_UINT8) {
         mp_print_str(print, ", dtype=uint8)");
     } else if(self->array->typecode == NDARRAY_INT8) {
         mp_print_str(print, ", dtype=int8)");
@@ -115,6 +307,16 @@ void ndarray_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t ki
         mp_print_str(print, ", dtype=uint16)");
     } else if(self->array->typecode == NDARRAY_INT16) {
         mp_print_str(print, ", dtype=int16)");
+    } else if(self->array->typecode == NDARRAY_UINT32) {
+        mp_print_str(print, ", dtype=uint32)");
+    } else if(self->array->typecode == NDARRAY_INT32) {
+        mp_print_str(print, ", dtype=int32)");
+    } else if(NDARRAY_IS_FLOAT32(self->array->typecode)) {
+        mp_print_str(print, ", dtype=float32)");
+    } else if(self->array->typecode == NDARRAY_FLOAT16) {
+        mp_print_str(print, ", dtype=float16)");
+    } else if(self->array->typecode == NDARRAY_COMPLEX) {
+        mp_print_str(print, ", dtype=complex)");
     } else if(self->array->typecode == NDARRAY_FLOAT) {
         mp_print_str(print, ", dtype=float)");
     }
@@ -124,30 +326,253 @@ void ndarray_assign_elements(mp_obj_array_t *data, mp_obj_t iterable, uint8_t ty
     // assigns a single row in the matrix
     mp_obj_t item;
     while ((item = mp_iternext(iterable)) != MP_OBJ_STOP_ITERATION) {
-        mp_binary_set_val_array(typecode, data->items, (*idx)++, item);
+        ndarray_set_value(typecode, data->items, (*idx)++, item);
     }
 }
 
-ndarray_obj_t *create_new_ndarray(size_t m, size_t n, uint8_t typecode) {
-    // Creates the base ndarray with shape (m, n), and initialises the values to straight 0s
+STATIC void ndarray_set_dense_strides(ndarray_obj_t *ndarray) {
+    // sets the strides of an ndarray, whose elements follow each other in C order
+    int32_t stride = 1;
+    for(uint8_t i=ULAB_MAX_DIMS; i > 0; i--) {
+        ndarray->strides[i-1] = stride;
+        stride *= ndarray->shape[i-1];
+    }
+}
+
+ndarray_obj_t *ndarray_new_empty(uint8_t ndim, size_t *shape, uint8_t typecode) {
+    // Creates the base ndarray with the given shape, but leaves the values uninitialised: 
+    // functions that overwrite each element of their output can save a pass over the memory. 
+    // shape must have ULAB_MAX_DIMS entries, aligned to the right, with leading 1s. 
+    // NDARRAY_BOOL results in a Boolean array with uint8 storage
     ndarray_obj_t *ndarray = m_new_obj(ndarray_obj_t);
     ndarray->base.type = &ulab_ndarray_type;
-    ndarray->m = m;
-    ndarray->n = n;
-    mp_obj_array_t *array = array_new(typecode, m*n);
-    ndarray->bytes = m * n * mp_binary_get_size('@', typecode, NULL);
-    // this should set all elements to 0, irrespective of the of the typecode (all bits are zero)
-    // we could, perhaps, leave this step out, and initialise the array only, when needed
-    memset(array->items, 0, ndarray->bytes); 
+    ndarray->ndim = ndim;
+    ndarray->boolean = (typecode == NDARRAY_BOOL);
+    if(ndarray->boolean) {
+        typecode = NDARRAY_UINT8;
+    }
+    ndarray->len = 1;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        ndarray->shape[i] = shape[i];
+        ndarray->len *= shape[i];
+    }
+    mp_obj_array_t *array = array_new(typecode, ndarray->len);
+    ndarray->bytes = ndarray->len * ndarray_itemsize(typecode);
     ndarray->array = array;
+    ndarray->items = array->items;
+    ndarray_set_dense_strides(ndarray);
     return ndarray;
 }
 
+ndarray_obj_t *ndarray_new_ndarray(uint8_t ndim, size_t *shape, uint8_t typecode) {
+    // Creates the base ndarray with the given shape, and initialises the values to straight 0s. 
+    ndarray_obj_t *ndarray = ndarray_new_empty(ndim, shape, typecode);
+    #if !MICROPY_GC_CONSERVATIVE_CLEAR
+    // this should set all elements to 0, irrespective of the of the typecode (all bits are zero); 
+    // if the garbage collector clears the blocks that it hands out, there is nothing left to do
+    memset(ndarray->items, 0, ndarray->bytes); 
+    #endif
+    return ndarray;
+}
+
+STATIC void ndarray_matrix_shape(size_t m, size_t n, size_t *shape) {
+    for(uint8_t i=0; i < ULAB_MAX_DIMS-2; i++) {
+        shape[i] = 1;
+    }
+    shape[ULAB_MAX_DIMS-2] = m;
+    shape[ULAB_MAX_DIMS-1] = n;
+}
+
+ndarray_obj_t *create_new_ndarray(size_t m, size_t n, uint8_t typecode) {
+    // Creates the base ndarray with shape (m, n)
+    size_t shape[ULAB_MAX_DIMS];
+    ndarray_matrix_shape(m, n, shape);
+    return ndarray_new_ndarray(2, shape, typecode);
+}
+
+ndarray_obj_t *create_empty_ndarray(size_t m, size_t n, uint8_t typecode) {
+    // Creates an uninitialised ndarray with shape (m, n)
+    size_t shape[ULAB_MAX_DIMS];
+    ndarray_matrix_shape(m, n, shape);
+    return ndarray_new_empty(2, shape, typecode);
+}
+
+ndarray_obj_t *ndarray_new_view(ndarray_obj_t *source, uint8_t ndim, size_t *shape, int32_t *strides, int32_t offset) {
+    // Creates an ndarray with the given shape that shares its storage with source. offset is the 
+    // position of the first element with respect to source->items, while the strides are 
+    // measured in the underlying storage; both are in units of the element size
+    ndarray_obj_t *ndarray = m_new_obj(ndarray_obj_t);
+    ndarray->base.type = &ulab_ndarray_type;
+    ndarray->ndim = ndim;
+    ndarray->boolean = source->boolean;
+    ndarray->len = 1;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        ndarray->shape[i] = shape[i];
+        ndarray->strides[i] = strides[i];
+        ndarray->len *= shape[i];
+    }
+    uint8_t _sizeof = ndarray_itemsize(source->array->typecode);
+    ndarray->bytes = ndarray->len * _sizeof;
+    ndarray->array = source->array;
+    ndarray->items = (uint8_t *)source->items + offset * _sizeof;
+    return ndarray;
+}
+
+bool ndarray_is_dense(ndarray_obj_t *ndarray) {
+    // returns true, if the elements are laid out in memory in C order without gaps, 
+    // i.e., if the data can be treated as a flat array of length ndarray->len
+    int32_t stride = 1;
+    for(uint8_t i=ULAB_MAX_DIMS; i > 0; i--) {
+        // the stride of an axis of length 1 is irrelevant
+        if((ndarray->shape[i-1] != 1) && (ndarray->strides[i-1] != stride)) {
+            return false;
+        }
+        stride *= ndarray->shape[i-1];
+    }
+    return true;
+}
+
+ndarray_obj_t *ndarray_contiguous(ndarray_obj_t *ndarray) {
+    // returns ndarray itself, if it is dense, and a dense copy otherwise; 
+    // functions that work on a flat array should call this first
+    if(ndarray_is_dense(ndarray)) {
+        return ndarray;
+    }
+    return MP_OBJ_TO_PTR(ndarray_copy(MP_OBJ_FROM_PTR(ndarray)));
+}
+
+void ndarray_copy_elements(ndarray_obj_t *target, ndarray_obj_t *source) {
+    // copies the elements of source into target; the shape and the typecode of 
+    // the two ndarrays must be the same, but either of them can be a view
+    uint8_t _sizeof = ndarray_itemsize(source->array->typecode);
+    if(ndarray_is_dense(target) && ndarray_is_dense(source)) {
+        memmove(target->items, source->items, source->bytes);
+        return;
+    }
+    int32_t tstrides[ULAB_MAX_DIMS], sstrides[ULAB_MAX_DIMS];
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        tstrides[i] = target->strides[i] * _sizeof;
+        sstrides[i] = source->strides[i] * _sizeof;
+    }
+    NDARRAY_LOOP2(source->shape, uint8_t, t, target->items, tstrides, uint8_t, s, source->items, sstrides, 
+                  memcpy(t, s, _sizeof));
+}
+
+ndarray_obj_t *ndarray_detach(ndarray_obj_t *source, ndarray_obj_t *target) {
+    // returns source, or a copy of it, if target shares the storage of source: an element of 
+    // source could then be overwritten, before it is read, unless the two are laid out identically. 
+    // The storage, and not the array headers are compared, because frombuffer(..., share=True) 
+    // creates a new header for each array that shares a buffer
+    if(source->array->items != target->array->items) {
+        return source;
+    }
+    bool identical = (source->items == target->items) && (source->array->typecode == target->array->typecode);
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        if((source->shape[i] != target->shape[i]) || 
+           ((source->shape[i] != 1) && (source->strides[i] != target->strides[i]))) {
+            identical = false;
+        }
+    }
+    return identical ? source : MP_OBJ_TO_PTR(ndarray_copy(MP_OBJ_FROM_PTR(source)));
+}
+
+ndarray_obj_t *ndarray_check_out(mp_obj_t out, size_t *shape, uint8_t typecode) {
+    // checks, whether out can hold the results of an operation of the given shape, and type
+    if(!mp_obj_is_type(out, &ulab_ndarray_type)) {
+        mp_raise_TypeError("out must be an ndarray");
+    }
+    ndarray_obj_t *ndarray = MP_OBJ_TO_PTR(out);
+    if(typecode == NDARRAY_BOOL) {
+        // Boolean results can also be written into uint8 arrays
+        typecode = NDARRAY_UINT8;
+    }
+    if(ndarray->array->typecode != typecode) {
+        mp_raise_TypeError("out has wrong type");
+    }
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        if(ndarray->shape[i] != shape[i]) {
+            mp_raise_ValueError("out has wrong shape");
+        }
+    }
+    return ndarray;
+}
+
+void ndarray_broadcast_shape(ndarray_obj_t *a, ndarray_obj_t *b, uint8_t *ndim, size_t *shape) {
+    // calculates the shape of the result of a binary operation on a, and b: 
+    // the axes have to be of equal length, or one of them must be of length 1
+    *ndim = (a->ndim > b->ndim) ? a->ndim : b->ndim;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        if((a->shape[i] != b->shape[i]) && (a->shape[i] != 1) && (b->shape[i] != 1)) {
+            mp_raise_ValueError("operands could not be broadcast together");
+        }
+        shape[i] = (a->shape[i] == 1) ? b->shape[i] : a->shape[i];
+    }
+}
+
+ndarray_obj_t *ndarray_binary_output(uint8_t ndim, size_t *shape, uint8_t typecode, ndarray_obj_t *target) {
+    // returns the ndarray, into which the result of a binary operation of the given shape is 
+    // written: either target, or, if target is NULL, a new ndarray
+    if(target == NULL) {
+        return ndarray_new_empty(ndim, shape, typecode);
+    }
+    ndarray_check_out(MP_OBJ_FROM_PTR(target), shape, typecode);
+    if(!ndarray_is_dense(target)) {
+        mp_raise_ValueError("out must be contiguous");
+    }
+    return target;
+}
+
+void ndarray_broadcast_strides(ndarray_obj_t *ndarray, int32_t *strides) {
+    // fills strides such that the axes of length 1 of ndarray are repeated, 
+    // when ndarray is walked through along with a larger array
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        strides[i] = (ndarray->shape[i] == 1) ? 0 : ndarray->strides[i];
+    }
+}
+
+uint8_t ndarray_normalise_axis(ndarray_obj_t *ndarray, mp_obj_t axis) {
+    // converts the axis keyword argument into an index of ndarray->shape; 
+    // negative values count from the last axis
+    int32_t ax = mp_obj_get_int(axis);
+    if(ax < 0) {
+        ax += ndarray->ndim;
+    }
+    if((ax < 0) || (ax >= ndarray->ndim)) {
+        mp_raise_ValueError("axis is out of bounds");
+    }
+    return ULAB_MAX_DIMS - ndarray->ndim + ax;
+}
+
+STATIC mp_obj_t ndarray_bool_list_axis(ndarray_obj_t *ndarray, uint8_t *items, uint8_t axis) {
+    mp_obj_t list = mp_obj_new_list(ndarray->shape[axis], NULL);
+    mp_obj_list_t *list_ptr = MP_OBJ_TO_PTR(list);
+    for(size_t i=0; i < ndarray->shape[axis]; i++) {
+        if(axis == ULAB_MAX_DIMS-1) {
+            list_ptr->items[i] = mp_obj_new_bool(*items);
+        } else {
+            list_ptr->items[i] = ndarray_bool_list_axis(ndarray, items, axis+1);
+        }
+        items += ndarray->strides[axis];
+    }
+    return list;
+}
+
+mp_obj_t ndarray_bool_list(ndarray_obj_t *ndarray) {
+    // converts a Boolean ndarray into a (nested) list of Trues, and Falses; 
+    // row vectors result in a flat list
+    if((ndarray->ndim == 2) && (ROWS(ndarray) == 1)) {
+        return ndarray_bool_list_axis(ndarray, (uint8_t *)ndarray->items, ULAB_MAX_DIMS-1);
+    }
+    return ndarray_bool_list_axis(ndarray, (uint8_t *)ndarray->items, ULAB_MAX_DIMS-ndarray->ndim);
+}
+
 mp_obj_t ndarray_copy(mp_obj_t self_in) {
-    // returns a verbatim (shape and typecode) copy of self_in
+    // returns a verbatim (shape and typecode) copy of self_in; the copy is always dense, 
+    // and detached from the storage of self_in, even if self_in is a view
     ndarray_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    ndarray_obj_t *out = create_new_ndarray(self->m, self->n, self->array->typecode);
-    memcpy(out->array->items, self->array->items, self->bytes);
+    ndarray_obj_t *out = ndarray_new_empty(self->ndim, self->shape, self->array->typecode);
+    out->boolean = self->boolean;
+    ndarray_copy_elements(out, self);
     return MP_OBJ_FROM_PTR(out);
 }
 
@@ -164,63 +589,278 @@ STATIC uint8_t ndarray_init_helper(size_t n_args, const mp_obj_t *pos_args, mp_m
     return dtype;
 }
 
+STATIC void ndarray_fill_axis(ndarray_obj_t *self, mp_obj_t iterable, uint8_t axis, uint8_t dtype, size_t *idx) {
+    // walks through the nested iterables, and checks that each of them has the expected length
+    mp_obj_t len_in = mp_obj_len_maybe(iterable);
+    if((len_in == MP_OBJ_NULL) || ((size_t)MP_OBJ_SMALL_INT_VALUE(len_in) != self->shape[axis])) {
+        mp_raise_ValueError("iterables are not of the same length");
+    }
+    if((axis == ULAB_MAX_DIMS-1) && (MP_OBJ_IS_TYPE(iterable, &mp_type_list) || MP_OBJ_IS_TYPE(iterable, &mp_type_tuple))) {
+        // the items of lists, and tuples can be read directly, without an iterator
+        size_t len;
+        mp_obj_t *items;
+        mp_obj_get_array(iterable, &len, &items);
+        for(size_t i=0; i < len; i++) {
+            if(self->boolean) {
+                ((uint8_t *)self->items)[(*idx)++] = mp_obj_is_true(items[i]);
+            } else {
+                ndarray_set_value(dtype, self->items, (*idx)++, items[i]);
+            }
+        }
+        return;
+    }
+    mp_obj_iter_buf_t iter_buf;
+    mp_obj_t item, iter = mp_getiter(iterable, &iter_buf);
+    if(axis == ULAB_MAX_DIMS-1) {
+        if(self->boolean) {
+            while((item = mp_iternext(iter)) != MP_OBJ_STOP_ITERATION) {
+                ((uint8_t *)self->items)[(*idx)++] = mp_obj_is_true(item);
+            }
+        } else {
+            ndarray_assign_elements(self->array, iter, dtype, idx);
+        }
+    } else {
+        while((item = mp_iternext(iter)) != MP_OBJ_STOP_ITERATION) {
+            ndarray_fill_axis(self, item, axis+1, dtype, idx);
+        }
+    }
+}
+
+STATIC ndarray_obj_t *ndarray_from_buffer(mp_obj_t iterable, uint8_t dtype) {
+    // array.arrays, bytes, and bytearrays hold numbers of a single type, which can be converted 
+    // in one pass, without creating micropython objects; returns NULL for unsupported typecodes
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(iterable, &bufinfo, MP_BUFFER_READ);
+    uint8_t typecode = bufinfo.typecode;
+    #if MICROPY_PY_BUILTINS_BYTEARRAY
+    if(typecode == BYTEARRAY_TYPECODE) {
+        typecode = NDARRAY_UINT8;
+    }
+    #endif
+    if((typecode != NDARRAY_UINT8) && (typecode != NDARRAY_INT8) && (typecode != NDARRAY_UINT16) && 
+       (typecode != NDARRAY_INT16) && (typecode != NDARRAY_UINT32) && (typecode != NDARRAY_INT32) && 
+       (typecode != NDARRAY_FLOAT) && !NDARRAY_IS_FLOAT32(typecode)) {
+        return NULL;
+    }
+    // the buffer is wrapped in a temporary row vector, whose header lives on the stack
+    mp_obj_array_t array = {{&mp_type_array}, typecode, 0, 0, bufinfo.buf};
+    ndarray_obj_t source;
+    source.base.type = &ulab_ndarray_type;
+    source.ndim = 2;
+    source.boolean = 0;
+    source.len = bufinfo.len / ndarray_itemsize(typecode);
+    source.bytes = source.len * ndarray_itemsize(typecode);
+    source.array = &array;
+    source.items = bufinfo.buf;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        source.shape[i] = 1;
+        source.strides[i] = source.len;
+    }
+    source.shape[ULAB_MAX_DIMS-1] = source.len;
+    source.strides[ULAB_MAX_DIMS-1] = 1;
+    array.len = source.len;
+    return ndarray_convert(&source, dtype == NDARRAY_BOOL ? NDARRAY_UINT8 : dtype, dtype == NDARRAY_BOOL, 
+                           false, ndarray_round_nearest);
+}
+
+#if MICROPY_PY_BUILTINS_RANGE_ATTRS
+STATIC ndarray_obj_t *ndarray_from_range(mp_obj_t range, uint8_t dtype) {
+    // the elements of a range are computed directly from its start, and step
+    mp_int_t start = mp_obj_get_int(mp_load_attr(range, MP_QSTR_start));
+    mp_int_t step = mp_obj_get_int(mp_load_attr(range, MP_QSTR_step));
+    ndarray_obj_t *ndarray = create_empty_ndarray(1, mp_obj_get_int(mp_obj_len(range)), dtype);
+    uint8_t typecode = ndarray->array->typecode;
+    if(ndarray->boolean) {
+        RANGE_LOOP(uint8_t, ndarray, start, step, a != 0);
+    } else if(typecode == NDARRAY_UINT8) {
+        RANGE_LOOP(uint8_t, ndarray, start, step, (uint8_t)a);
+    } else if(typecode == NDARRAY_INT8) {
+        RANGE_LOOP(int8_t, ndarray, start, step, (int8_t)a);
+    } else if(typecode == NDARRAY_UINT16) {
+        RANGE_LOOP(uint16_t, ndarray, start, step, (uint16_t)a);
+    } else if(typecode == NDARRAY_INT16) {
+        RANGE_LOOP(int16_t, ndarray, start, step, (int16_t)a);
+    } else if(typecode == NDARRAY_UINT32) {
+        RANGE_LOOP(uint32_t, ndarray, start, step, (uint32_t)a);
+    } else if(typecode == NDARRAY_INT32) {
+        RANGE_LOOP(int32_t, ndarray, start, step, (int32_t)a);
+    } else if(NDARRAY_IS_FLOAT32(typecode)) {
+        RANGE_LOOP(float, ndarray, start, step, (float)a);
+    } else if(typecode == NDARRAY_FLOAT16) {
+        RANGE_LOOP(uint16_t, ndarray, start, step, ndarray_float_to_float16((mp_float_t)a));
+    } else if(typecode == NDARRAY_COMPLEX) {
+        mp_float_t *array = (mp_float_t *)ndarray->items;
+        for(size_t i=0; i < ndarray->len; i++, start += step) {
+            *array++ = (mp_float_t)start;
+            *array++ = MICROPY_FLOAT_CONST(0.0);
+        }
+    } else {
+        RANGE_LOOP(mp_float_t, ndarray, start, step, (mp_float_t)a);
+    }
+    return ndarray;
+}
+#endif
+
 mp_obj_t ndarray_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
     mp_arg_check_num(n_args, n_kw, 1, 2, true);
     mp_map_t kw_args;
     mp_map_init_fixed_table(&kw_args, n_kw, args + n_args);
     uint8_t dtype = ndarray_init_helper(n_args, args, &kw_args);
 
-    size_t len1, len2=0, i=0;
-    mp_obj_t len_in = mp_obj_len_maybe(args[0]);
-    if (len_in == MP_OBJ_NULL) {
+    // sources, whose elements are all of the same type, are converted without iterating over them
+    if(MP_OBJ_IS_TYPE(args[0], &ulab_ndarray_type)) {
+        // the shape is retained, and floats are rounded to the nearest integer, if dtype is an integer type
+        bool boolean = (dtype == NDARRAY_BOOL);
+        return MP_OBJ_FROM_PTR(ndarray_convert(MP_OBJ_TO_PTR(args[0]), boolean ? NDARRAY_UINT8 : dtype, boolean, 
+                                               false, ndarray_round_nearest));
+    }
+    if(MP_OBJ_IS_TYPE(args[0], &mp_type_array) || 
+       #if MICROPY_PY_BUILTINS_BYTEARRAY
+       MP_OBJ_IS_TYPE(args[0], &mp_type_bytearray) || 
+       #endif
+       MP_OBJ_IS_TYPE(args[0], &mp_type_bytes)) {
+        ndarray_obj_t *ndarray = ndarray_from_buffer(args[0], dtype);
+        if(ndarray != NULL) {
+            return MP_OBJ_FROM_PTR(ndarray);
+        }
+    }
+    #if MICROPY_PY_BUILTINS_RANGE_ATTRS
+    if(MP_OBJ_IS_TYPE(args[0], &mp_type_range)) {
+        return MP_OBJ_FROM_PTR(ndarray_from_range(args[0], dtype));
+    }
+    #endif
+    if(mp_obj_len_maybe(args[0]) == MP_OBJ_NULL) {
         mp_raise_ValueError("first argument must be an iterable");
-    } else {
-        // len1 is either the number of rows (for matrices), or the number of elements (row vectors)
-        len1 = MP_OBJ_SMALL_INT_VALUE(len_in);
-    }
-
-    // We have to figure out, whether the first element of the iterable is an iterable itself
-    // Perhaps, there is a more elegant way of handling this
-    mp_obj_iter_buf_t iter_buf1;
-    mp_obj_t item1, iterable1 = mp_getiter(args[0], &iter_buf1);
-    while ((item1 = mp_iternext(iterable1)) != MP_OBJ_STOP_ITERATION) {
-        len_in = mp_obj_len_maybe(item1);
-        if(len_in != MP_OBJ_NULL) { // indeed, this seems to be an iterable
-            // Next, we have to check, whether all elements in the outer loop have the same length
-            if(i > 0) {
-                if(len2 != MP_OBJ_SMALL_INT_VALUE(len_in)) {
-                    mp_raise_ValueError("iterables are not of the same length");
-                }
-            }
-            len2 = MP_OBJ_SMALL_INT_VALUE(len_in);
-            i++;
+    }
+    // We have to figure out the shape first: the first element at each level of nesting 
+    // determines the length of the next axis
+    size_t shape[ULAB_MAX_DIMS];
+    uint8_t ndim = 0;
+    mp_obj_t item = args[0], len_in;
+    while((len_in = mp_obj_len_maybe(item)) != MP_OBJ_NULL) {
+        if(ndim == ULAB_MAX_DIMS) {
+            mp_raise_ValueError("too many dimensions");
+        }
+        shape[ndim++] = MP_OBJ_SMALL_INT_VALUE(len_in);
+        if(MP_OBJ_SMALL_INT_VALUE(len_in) == 0) {
+            break;
         }
+        mp_obj_iter_buf_t iter_buf;
+        item = mp_iternext(mp_getiter(item, &iter_buf));
     }
-    // By this time, it should be established, what the shape is, so we can now create the array
-    ndarray_obj_t *self = create_new_ndarray((len2 == 0) ? 1 : len1, (len2 == 0) ? len1 : len2, dtype);
-    iterable1 = mp_getiter(args[0], &iter_buf1);
-    i = 0;
-    if(len2 == 0) { // the first argument is a single iterable
-        ndarray_assign_elements(self->array, iterable1, dtype, &i);
-    } else {
-        mp_obj_iter_buf_t iter_buf2;
-        mp_obj_t iterable2; 
+    // shift the shape to the right, and pad it with 1s; a single iterable is a row vector
+    size_t new_shape[ULAB_MAX_DIMS];
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        new_shape[i] = 1;
+    }
+    for(uint8_t i=0; i < ndim; i++) {
+        new_shape[ULAB_MAX_DIMS-ndim+i] = shape[i];
+    }
+    ndarray_obj_t *self = ndarray_new_empty(ndim < 2 ? 2 : ndim, new_shape, dtype);
+    size_t idx = 0;
+    ndarray_fill_axis(self, args[0], ULAB_MAX_DIMS-ndim, self->array->typecode, &idx);
+    return MP_OBJ_FROM_PTR(self);
+}
 
-        while ((item1 = mp_iternext(iterable1)) != MP_OBJ_STOP_ITERATION) {
-            iterable2 = mp_getiter(item1, &iter_buf2);
-            ndarray_assign_elements(self->array, iterable2, dtype, &i);
+mp_obj_t ndarray_frombuffer(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+        { MP_QSTR_dtype, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = NDARRAY_FLOAT } },
+        { MP_QSTR_count, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = -1 } },
+        { MP_QSTR_offset, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0 } },
+        { MP_QSTR_share, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = false } },
+    };
+    
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    
+    uint8_t dtype = args[1].u_int;
+    bool boolean = (dtype == NDARRAY_BOOL);
+    if(boolean) {
+        dtype = NDARRAY_UINT8;
+    }
+    if((dtype != NDARRAY_UINT8) && (dtype != NDARRAY_INT8) && (dtype != NDARRAY_UINT16) && 
+       (dtype != NDARRAY_INT16) && (dtype != NDARRAY_UINT32) && (dtype != NDARRAY_INT32) && 
+       !NDARRAY_IS_FLOAT(dtype) && (dtype != NDARRAY_COMPLEX)) {
+        mp_raise_TypeError("data type not understood");
+    }
+    int32_t count = args[2].u_int, offset = args[3].u_int;
+    uint8_t _sizeof = ndarray_itemsize(dtype);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0].u_obj, &bufinfo, MP_BUFFER_READ);
+    if((offset < 0) || ((size_t)offset > bufinfo.len)) {
+        mp_raise_ValueError("offset must be non-negative and no greater than buffer length");
+    }
+    size_t bytes = bufinfo.len - offset;
+    if(count < 0) {
+        if(bytes % _sizeof != 0) {
+            mp_raise_ValueError("buffer size must be a multiple of element size");
         }
+        count = bytes / _sizeof;
+    } else if((size_t)count * _sizeof > bytes) {
+        mp_raise_ValueError("buffer is smaller than requested size");
     }
-    return MP_OBJ_FROM_PTR(self);
+    uint8_t *items = (uint8_t *)bufinfo.buf + offset;
+    mp_obj_t source = args[0].u_obj;
+    if(!args[4].u_bool || 
+       !(MP_OBJ_IS_TYPE(source, &mp_type_array) || 
+         #if MICROPY_PY_BUILTINS_BYTEARRAY
+         MP_OBJ_IS_TYPE(source, &mp_type_bytearray) || 
+         #endif
+         #if MICROPY_PY_BUILTINS_MEMORYVIEW
+         MP_OBJ_IS_TYPE(source, &mp_type_memoryview) || 
+         #endif
+         false) || 
+         !mp_get_buffer(source, &bufinfo, MP_BUFFER_WRITE) || ((uintptr_t)items % _sizeof != 0)) {
+        // The data are copied, unless sharing is requested: a bytearray, or array could be 
+        // resized later, and its storage moved, while the ndarray would still point to the old block. 
+        // bytes, and read-only memoryviews are immutable, and we know nothing of the layout of other 
+        // buffers; unaligned data can't be dereferenced directly on all platforms. 
+        // In all these cases, the data are copied, even if share is True
+        ndarray_obj_t *ndarray = create_empty_ndarray(1, count, dtype);
+        ndarray->boolean = boolean;
+        memcpy(ndarray->items, items, ndarray->bytes);
+        return MP_OBJ_FROM_PTR(ndarray);
+    }
+    // the storage of the source is shared: the new array header points to the start of the 
+    // memory block of source, so that the garbage collector keeps the data alive, as long as 
+    // the source is not resized, while ndarray->items points to the first requested element
+    mp_obj_array_t *array = m_new_obj(mp_obj_array_t);
+    array->base.type = &mp_type_array;
+    array->typecode = dtype;
+    array->free = 0;
+    array->len = count;
+    array->items = ((mp_obj_array_t *)MP_OBJ_TO_PTR(source))->items;
+    ndarray_obj_t *ndarray = m_new_obj(ndarray_obj_t);
+    ndarray->base.type = &ulab_ndarray_type;
+    ndarray->ndim = 2;
+    ndarray->boolean = boolean;
+    ndarray->len = count;
+    ndarray->bytes = count * _sizeof;
+    ndarray->array = array;
+    ndarray->items = items;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        ndarray->shape[i] = 1;
+        ndarray->strides[i] = count;
+    }
+    COLUMNS(ndarray) = count;
+    ndarray->strides[ULAB_MAX_DIMS-1] = 1;
+    return MP_OBJ_FROM_PTR(ndarray);
 }
 
 size_t slice_length(mp_bound_slice_t slice) {
-    // TODO: check, whether this is true!
+    // returns the number of elements selected by slice; for negative steps, 
+    // mp_seq_get_fast_slice_indexes returns a stop value that is inclusive
     if(slice.step < 0) {
-        slice.step = -slice.step;
-        return (slice.start - slice.stop) / slice.step;
+        if(slice.start < slice.stop) {
+            return 0;
+        }
+        return (slice.start - slice.stop) / (-slice.step) + 1;
     } else {
-        return (slice.stop - slice.start) / slice.step;        
+        if(slice.stop <= slice.start) {
+            return 0;
+        }
+        return (slice.stop - slice.start + slice.step - 1) / slice.step;
     }
 }
 
@@ -273,33 +913,93 @@ mp_bound_slice_t simple_slice(int16_t start, int16_t stop, int16_t step) {
     return slice;
 }
 
-void insert_binary_value(ndarray_obj_t *ndarray, size_t nd_index, ndarray_obj_t *values, size_t value_index) {
+STATIC int32_t ndarray_index(ndarray_obj_t *ndarray, size_t row, size_t column) {
+    // returns the position of the element (row, column) of a matrix with respect to ndarray->items
+    return (int32_t)row * ndarray->strides[ULAB_MAX_DIMS-2] + (int32_t)column * ndarray->strides[ULAB_MAX_DIMS-1];
+}
+
+STATIC int32_t ndarray_get_int_value(uint8_t typecode, void *item) {
+    // reads a single element of an integer array; uint32 values are returned with their bits unchanged
+    if(typecode == NDARRAY_UINT8) {
+        return *(uint8_t *)item;
+    } else if(typecode == NDARRAY_INT8) {
+        return *(int8_t *)item;
+    } else if(typecode == NDARRAY_UINT16) {
+        return *(uint16_t *)item;
+    } else if(typecode == NDARRAY_INT16) {
+        return *(int16_t *)item;
+    } else {
+        return *(int32_t *)item;
+    }
+}
+
+STATIC void ndarray_set_binary_value(uint8_t target_typecode, void *target, uint8_t source_typecode, void *source) {
+    // converts the single element at source to target_typecode, and writes it to target; 
+    // floats are rounded to the nearest integer, if the target is of integer type
+    mp_float_t f;
+    int64_t x;
+    if(target_typecode == NDARRAY_COMPLEX) {
+        ndarray_get_complex_value(source, source_typecode, 0, &((mp_float_t *)target)[0], &((mp_float_t *)target)[1]);
+        return;
+    }
+    if(NDARRAY_IS_FLOAT(source_typecode) || (source_typecode == NDARRAY_COMPLEX)) {
+        f = ndarray_get_float_value(source, source_typecode, 0);
+        // the conversion goes through int64, so that values beyond the range of int32 are not lost for uint32
+        x = ndarray_float_to_integer(f, ndarray_round_nearest, false, 0, 0);
+    } else {
+        x = (source_typecode == NDARRAY_UINT32) ? (int64_t)*(uint32_t *)source : ndarray_get_int_value(source_typecode, source);
+        f = (mp_float_t)x;
+    }
+    if(target_typecode == NDARRAY_UINT8) {
+        *(uint8_t *)target = (uint8_t)x;
+    } else if(target_typecode == NDARRAY_INT8) {
+        *(int8_t *)target = (int8_t)x;
+    } else if(target_typecode == NDARRAY_UINT16) {
+        *(uint16_t *)target = (uint16_t)x;
+    } else if(target_typecode == NDARRAY_INT16) {
+        *(int16_t *)target = (int16_t)x;
+    } else if(target_typecode == NDARRAY_UINT32) {
+        *(uint32_t *)target = (uint32_t)x;
+    } else if(target_typecode == NDARRAY_INT32) {
+        *(int32_t *)target = (int32_t)x;
+    } else {
+        ndarray_set_float_value(target, target_typecode, 0, f);
+    }
+}
+
+void insert_binary_value(ndarray_obj_t *ndarray, int32_t nd_index, ndarray_obj_t *values, int32_t value_index) {
     // there is probably a more elegant implementation...
-    mp_obj_t tmp = mp_binary_get_val_array(values->array->typecode, values->array->items, value_index);
-    if((values->array->typecode == NDARRAY_FLOAT) && (ndarray->array->typecode != NDARRAY_FLOAT)) {
-        // workaround: rounding seems not to work in the arm compiler
-        int32_t x = (int32_t)floorf(mp_obj_get_float(tmp)+0.5);
-        tmp = mp_obj_new_int(x);
+    // the indices can be negative in views with negative strides, so we work with pointers here
+    uint8_t *source = (uint8_t *)values->items + value_index * ndarray_itemsize(values->array->typecode);
+    uint8_t *target = (uint8_t *)ndarray->items + nd_index * ndarray_itemsize(ndarray->array->typecode);
+    ndarray_set_binary_value(ndarray->array->typecode, target, values->array->typecode, source);
+}
+
+STATIC void ndarray_check_bool_lists(ndarray_obj_t *ndarray, mp_obj_t row_list, mp_obj_t column_list) {
+    // a Boolean list must be exactly as long as the axis that it indexes
+    if(((row_list != mp_const_none) && ((size_t)mp_obj_get_int(mp_obj_len(row_list)) != ROWS(ndarray))) || 
+       ((column_list != mp_const_none) && ((size_t)mp_obj_get_int(mp_obj_len(column_list)) != COLUMNS(ndarray)))) {
+        mp_raise_msg(&mp_type_IndexError, "Boolean index does not match the shape of the array");
     }
-    mp_binary_set_val_array(ndarray->array->typecode, ndarray->array->items, nd_index, tmp); 
 }
 
 mp_obj_t insert_slice_list(ndarray_obj_t *ndarray, size_t m, size_t n, 
                             mp_bound_slice_t row, mp_bound_slice_t column, 
                             mp_obj_t row_list, mp_obj_t column_list, 
                             ndarray_obj_t *values) {
-    if((m != values->m) && (n != values->n)) {
-        if((values->array->len != 1)) { // not a single item
+    ndarray_check_bool_lists(ndarray, row_list, column_list);
+    if((m != ROWS(values)) && (n != COLUMNS(values))) {
+        if((values->len != 1)) { // not a single item
             mp_raise_ValueError("could not broadast input array from shape");
         }
     }
-    size_t cindex, rindex;
+    int32_t cindex, rindex;
     // M, and N are used to manipulate how the source index is incremented in the loop
     uint8_t M = 1, N = 1;
-    if(values->m == 1) {
+    if(ROWS(values) == 1) {
         M = 0;
     }
-    if(values->n == 1) {
+    if(COLUMNS(values) == 1) {
         N = 0;
     }
     
@@ -309,7 +1009,7 @@ mp_obj_t insert_slice_list(ndarray_obj_t *ndarray, size_t m, size_t n,
             for(size_t i=0; i < m; i++) {
                 cindex = column.start;
                 for(size_t j=0; j < n; j++) {
-                    insert_binary_value(ndarray, rindex*ndarray->n+cindex, values, i*M*n+j*N);
+                    insert_binary_value(ndarray, ndarray_index(ndarray, rindex, cindex), values, ndarray_index(values, i*M, j*N));
                     cindex += column.step;
                 }
                 rindex += row.step;
@@ -323,7 +1023,7 @@ mp_obj_t insert_slice_list(ndarray_obj_t *ndarray, size_t m, size_t n,
                 cindex = 0;
                 while((column_item = mp_iternext(column_iterable)) != MP_OBJ_STOP_ITERATION) {
                     if(mp_obj_is_true(column_item)) {
-                        insert_binary_value(ndarray, rindex*ndarray->n+cindex, values, i*M*n+j*N);
+                        insert_binary_value(ndarray, ndarray_index(ndarray, rindex, cindex), values, ndarray_index(values, i*M, j*N));
                         j++;
                     }
                     cindex++;
@@ -342,7 +1042,7 @@ mp_obj_t insert_slice_list(ndarray_obj_t *ndarray, size_t m, size_t n,
                 if(mp_obj_is_true(row_item)) {
                     cindex = column.start;
                     for(size_t j=0; j < n; j++) {
-                        insert_binary_value(ndarray, rindex*ndarray->n+cindex, values, i*M*n+j*N);
+                        insert_binary_value(ndarray, ndarray_index(ndarray, rindex, cindex), values, ndarray_index(values, i*M, j*N));
                         cindex += column.step;
                     }
                     i++;
@@ -352,13 +1052,14 @@ mp_obj_t insert_slice_list(ndarray_obj_t *ndarray, size_t m, size_t n,
         } else { // columns are indexed by a list
             mp_obj_iter_buf_t column_iter_buf;
             mp_obj_t column_item, column_iterable;
-            size_t j = 0, cindex = 0;
             while((row_item = mp_iternext(row_iterable)) != MP_OBJ_STOP_ITERATION) {
                 if(mp_obj_is_true(row_item)) {
-                    column_iterable = mp_getiter(column_list, &column_iter_buf);                   
+                    column_iterable = mp_getiter(column_list, &column_iter_buf);
+                    size_t j = 0;
+                    cindex = 0;
                     while((column_item = mp_iternext(column_iterable)) != MP_OBJ_STOP_ITERATION) {
                         if(mp_obj_is_true(column_item)) {
-                            insert_binary_value(ndarray, rindex*ndarray->n+cindex, values, i*M*n+j*N);
+                            insert_binary_value(ndarray, ndarray_index(ndarray, rindex, cindex), values, ndarray_index(values, i*M, j*N));
                             j++;
                         }
                         cindex++;
@@ -376,6 +1077,7 @@ mp_obj_t iterate_slice_list(ndarray_obj_t *ndarray, size_t m, size_t n,
                             mp_bound_slice_t row, mp_bound_slice_t column, 
                             mp_obj_t row_list, mp_obj_t column_list, 
                             ndarray_obj_t *values) {
+    ndarray_check_bool_lists(ndarray, row_list, column_list);
     if((m == 0) || (n == 0)) {
         mp_raise_msg(&mp_type_IndexError, "empty index range");
     }
@@ -383,39 +1085,43 @@ mp_obj_t iterate_slice_list(ndarray_obj_t *ndarray, size_t m, size_t n,
     if(values != NULL) {
         return insert_slice_list(ndarray, m, n, row, column, row_list, column_list, values);
     }
-    uint8_t _sizeof = mp_binary_get_size('@', ndarray->array->typecode, NULL);
+    if((row_list == mp_const_none) && (column_list == mp_const_none)) {
+        // both axes are indexed by a slice, or an integer, so the result can share the storage
+        // with ndarray; stepping in the slice simply multiplies the strides
+        size_t shape[ULAB_MAX_DIMS];
+        int32_t strides[ULAB_MAX_DIMS];
+        for(uint8_t i=0; i < ULAB_MAX_DIMS-2; i++) {
+            shape[i] = 1;
+            strides[i] = 0;
+        }
+        shape[ULAB_MAX_DIMS-2] = m;
+        shape[ULAB_MAX_DIMS-1] = n;
+        strides[ULAB_MAX_DIMS-2] = ndarray->strides[ULAB_MAX_DIMS-2] * row.step;
+        strides[ULAB_MAX_DIMS-1] = ndarray->strides[ULAB_MAX_DIMS-1] * column.step;
+        return MP_OBJ_FROM_PTR(ndarray_new_view(ndarray, 2, shape, strides, ndarray_index(ndarray, row.start, column.start)));
+    }
+    uint8_t _sizeof = ndarray_itemsize(ndarray->array->typecode);
     ndarray_obj_t *out = create_new_ndarray(m, n, ndarray->array->typecode);
-    uint8_t *target = (uint8_t *)out->array->items;
-    uint8_t *source = (uint8_t *)ndarray->array->items;
-    size_t cindex, rindex;    
-    if(row_list == mp_const_none) { // rows are indexed by a slice
+    out->boolean = ndarray->boolean;
+    uint8_t *target = (uint8_t *)out->items;
+    uint8_t *source = (uint8_t *)ndarray->items;
+    int32_t cindex, rindex;    
+    if(row_list == mp_const_none) { // rows are indexed by a slice, columns by a Boolean list
         rindex = row.start;
-        if(column_list == mp_const_none) { // columns are indexed by a slice
-            for(size_t i=0; i < m; i++) {
-                cindex = column.start;
-                for(size_t j=0; j < n; j++) {
-                    memcpy(target+(i*n+j)*_sizeof, source+(rindex*ndarray->n+cindex)*_sizeof, _sizeof);
-                    cindex += column.step;
+        mp_obj_iter_buf_t column_iter_buf;
+        mp_obj_t column_item, column_iterable;
+        for(size_t i=0; i < m; i++) {
+            column_iterable = mp_getiter(column_list, &column_iter_buf);
+            size_t j = 0;
+            cindex = 0;
+            while((column_item = mp_iternext(column_iterable)) != MP_OBJ_STOP_ITERATION) {
+                if(mp_obj_is_true(column_item)) {
+                    memcpy(target+(i*n+j)*_sizeof, source+ndarray_index(ndarray, rindex, cindex)*_sizeof, _sizeof);
+                    j++;
                 }
-                rindex += row.step;
-            }
-        } else { // columns are indexed by a Boolean list
-            // TODO: the list must be exactly as long as the axis
-            mp_obj_iter_buf_t column_iter_buf;
-            mp_obj_t column_item, column_iterable;
-            for(size_t i=0; i < m; i++) {
-                column_iterable = mp_getiter(column_list, &column_iter_buf);
-                size_t j = 0;
-                cindex = 0;
-                while((column_item = mp_iternext(column_iterable)) != MP_OBJ_STOP_ITERATION) {
-                    if(mp_obj_is_true(column_item)) {
-                        memcpy(target+(i*n+j)*_sizeof, source+(rindex*ndarray->n+cindex)*_sizeof, _sizeof);
-                        j++;
-                    }
-                    cindex++;
-                }
-                rindex += row.step;
+                cindex++;
             }
+            rindex += row.step;
         }
     } else { // rows are indexed by a Boolean list
         mp_obj_iter_buf_t row_iter_buf;
@@ -428,7 +1134,7 @@ mp_obj_t iterate_slice_list(ndarray_obj_t *ndarray, size_t m, size_t n,
                 if(mp_obj_is_true(row_item)) {
                     cindex = column.start;
                     for(size_t j=0; j < n; j++) {
-                        memcpy(target+(i*n+j)*_sizeof, source+(rindex*ndarray->n+cindex)*_sizeof, _sizeof);
+                        memcpy(target+(i*n+j)*_sizeof, source+ndarray_index(ndarray, rindex, cindex)*_sizeof, _sizeof);
                         cindex += column.step;
                     }
                     i++;
@@ -438,13 +1144,14 @@ mp_obj_t iterate_slice_list(ndarray_obj_t *ndarray, size_t m, size_t n,
         } else { // columns are indexed by a list
             mp_obj_iter_buf_t column_iter_buf;
             mp_obj_t column_item, column_iterable;
-            size_t j = 0, cindex = 0;
             while((row_item = mp_iternext(row_iterable)) != MP_OBJ_STOP_ITERATION) {
                 if(mp_obj_is_true(row_item)) {
-                    column_iterable = mp_getiter(column_list, &column_iter_buf);                   
+                    column_iterable = mp_getiter(column_list, &column_iter_buf);
+                    size_t j = 0;
+                    cindex = 0;
                     while((column_item = mp_iternext(column_iterable)) != MP_OBJ_STOP_ITERATION) {
                         if(mp_obj_is_true(column_item)) {
-                            memcpy(target+(i*n+j)*_sizeof, source+(rindex*ndarray->n+cindex)*_sizeof, _sizeof);
+                            memcpy(target+(i*n+j)*_sizeof, source+ndarray_index(ndarray, rindex, cindex)*_sizeof, _sizeof);
                             j++;
                         }
                         cindex++;
@@ -458,33 +1165,623 @@ mp_obj_t iterate_slice_list(ndarray_obj_t *ndarray, size_t m, size_t n,
     return MP_OBJ_FROM_PTR(out);
 }
 
-mp_obj_t ndarray_get_slice(ndarray_obj_t *ndarray, mp_obj_t index, ndarray_obj_t *values) {
-    mp_bound_slice_t row_slice = simple_slice(0, 0, 1), column_slice = simple_slice(0, 0, 1);
+STATIC void ndarray_assign_view(ndarray_obj_t *view, ndarray_obj_t *values) {
+    // writes values into the elements of view; the axes of length 1 of values are broadcast
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        if((values->shape[i] != view->shape[i]) && (values->shape[i] != 1)) {
+            mp_raise_ValueError("could not broadast input array from shape");
+        }
+    }
+    uint8_t tsize = ndarray_itemsize(view->array->typecode);
+    uint8_t vsize = ndarray_itemsize(values->array->typecode);
+    int32_t tstrides[ULAB_MAX_DIMS], vstrides[ULAB_MAX_DIMS];
+    ndarray_broadcast_strides(values, vstrides);
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        tstrides[i] = view->strides[i] * tsize;
+        vstrides[i] *= vsize;
+    }
+    NDARRAY_LOOP2(view->shape, uint8_t, t, view->items, tstrides, uint8_t, v, values->items, vstrides, 
+                  ndarray_set_binary_value(view->array->typecode, t, values->array->typecode, v));
+}
 
-    size_t m = 0, n = 0;
-    if(mp_obj_is_int(index) && (ndarray->m == 1) && (values == NULL)) { 
-        // we have a row vector, and don't want to assign
-        column_slice = generate_slice(ndarray->n, index);
-        if(slice_length(column_slice) == 1) { // we were asked for a single item
-            // subscribe returns an mp_obj_t, if and only, if the index is an integer, and we have a row vector
-            return mp_binary_get_val_array(ndarray->array->typecode, ndarray->array->items, column_slice.start);
+STATIC mp_obj_t ndarray_get_slice_nd(ndarray_obj_t *ndarray, mp_obj_t index, ndarray_obj_t *values) {
+    // indexing of arrays with more than two dimensions: each axis can be indexed by an integer, 
+    // or a slice, and the missing indices at the end select the whole axis. Integers remove 
+    // the axis, so that the result is always a view with fewer, or the same number of dimensions
+    size_t n_index = 1;
+    mp_obj_t *items = &index;
+    if(MP_OBJ_IS_TYPE(index, &mp_type_tuple)) {
+        mp_obj_get_array(index, &n_index, &items);
+    }
+    if(n_index > ndarray->ndim) {
+        mp_raise_msg(&mp_type_IndexError, "too many indices");
+    }
+    size_t shape[ULAB_MAX_DIMS];
+    int32_t strides[ULAB_MAX_DIMS], offset = 0;
+    uint8_t ndim = 0;
+    for(uint8_t i=0; i < ndarray->ndim; i++) {
+        uint8_t axis = ULAB_MAX_DIMS - ndarray->ndim + i;
+        if(i < n_index) {
+            if(!mp_obj_is_int(items[i]) && !MP_OBJ_IS_TYPE(items[i], &mp_type_slice)) {
+                mp_raise_msg(&mp_type_IndexError, "indices must be integers, or slices");
+            }
+            mp_bound_slice_t slice = generate_slice(ndarray->shape[axis], items[i]);
+            offset += slice.start * ndarray->strides[axis];
+            if(mp_obj_is_int(items[i])) { // the axis is dropped
+                continue;
+            }
+            shape[ndim] = slice_length(slice);
+            strides[ndim] = ndarray->strides[axis] * slice.step;
+        } else {
+            shape[ndim] = ndarray->shape[axis];
+            strides[ndim] = ndarray->strides[axis];
+        }
+        ndim++;
+    }
+    uint8_t _sizeof = ndarray_itemsize(ndarray->array->typecode);
+    if(ndim == 0) { // all axes were indexed by integers, so we have a single item
+        uint8_t *item = (uint8_t *)ndarray->items + offset * _sizeof;
+        if(values == NULL) {
+            return ndarray_get_item(ndarray, item);
+        }
+        if(values->len != 1) {
+            mp_raise_ValueError("could not broadast input array from shape");
+        }
+        ndarray_set_binary_value(ndarray->array->typecode, item, values->array->typecode, values->items);
+        return mp_const_none;
+    }
+    // shift the shape to the right, and pad it with 1s
+    size_t new_shape[ULAB_MAX_DIMS];
+    int32_t new_strides[ULAB_MAX_DIMS];
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        new_shape[i] = 1;
+        new_strides[i] = 0;
+    }
+    for(uint8_t i=0; i < ndim; i++) {
+        new_shape[ULAB_MAX_DIMS-ndim+i] = shape[i];
+        new_strides[ULAB_MAX_DIMS-ndim+i] = strides[i];
+    }
+    ndarray_obj_t *view = ndarray_new_view(ndarray, ndim < 2 ? 2 : ndim, new_shape, new_strides, offset);
+    if(values == NULL) {
+        return MP_OBJ_FROM_PTR(view);
+    }
+    ndarray_assign_view(view, values);
+    return mp_const_none;
+}
+
+STATIC ndarray_obj_t *ndarray_assignment_values(ndarray_obj_t *self, mp_obj_t value) {
+    // the value of an assignment to the elements of self must be an ndarray, or a scalar
+    ndarray_obj_t *values = NULL;
+    bool is_complex = false;
+    #if ULAB_HAS_COMPLEX
+    is_complex = MP_OBJ_IS_TYPE(value, &mp_type_complex);
+    #endif
+    if(!MP_OBJ_IS_TYPE(value, &ulab_ndarray_type) && 
+      !mp_obj_is_int(value) && !mp_obj_is_float(value) && !is_complex) {
+        mp_raise_ValueError("right hand side must be an ndarray, or a scalar");
+    }
+    if(is_complex) {
+        // the value is converted to the type of self, which raises a TypeError, if self is real
+        values = create_new_ndarray(1, 1, self->array->typecode);
+        ndarray_set_value(values->array->typecode, values->items, 0, value);
+    } else if(self->boolean && !MP_OBJ_IS_TYPE(value, &ulab_ndarray_type)) {
+        values = create_new_ndarray(1, 1, NDARRAY_UINT8);
+        *(uint8_t *)values->items = mp_obj_is_true(value);
+    } else if(mp_obj_is_int(value)) {
+        values = create_new_ndarray(1, 1, self->array->typecode);
+        ndarray_set_value(values->array->typecode, values->items, 0, value);   
+    } else if(mp_obj_is_float(value)) {
+        values = create_new_ndarray(1, 1, NDARRAY_FLOAT);
+        ndarray_set_value(NDARRAY_FLOAT, values->items, 0, value);
+    } else {
+        values = MP_OBJ_TO_PTR(value);
+        if(values->array->items == self->array->items) {
+            // the right hand side is a view into self, so the regions might overlap
+            values = MP_OBJ_TO_PTR(ndarray_copy(value));
+        }
+    }
+    return values;
+}
+
+STATIC ndarray_obj_t *ndarray_values_like(ndarray_obj_t *ndarray, ndarray_obj_t *values) {
+    // returns the elements of values in a dense array of the type of ndarray, so that they can be 
+    // inserted into ndarray by simply copying them; values that have to be converted are 
+    // converted only once, and not at each position, where they are inserted
+    if((values->array->typecode == ndarray->array->typecode) && (values->boolean == ndarray->boolean)) {
+        return ndarray_contiguous(values);
+    }
+    ndarray_obj_t *converted = create_empty_ndarray(1, values->len, ndarray->array->typecode);
+    uint8_t _sizeof = ndarray_itemsize(ndarray->array->typecode);
+    uint8_t vsize = ndarray_itemsize(values->array->typecode);
+    uint8_t *target = (uint8_t *)converted->items;
+    int32_t vstrides[ULAB_MAX_DIMS];
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        vstrides[i] = values->strides[i] * vsize;
+    }
+    NDARRAY_LOOP(values->shape, uint8_t, v, values->items, vstrides, 
+                 ndarray_set_binary_value(ndarray->array->typecode, target, values->array->typecode, v); 
+                 if(ndarray->boolean) *target = (*target != 0); 
+                 target += _sizeof);
+    return converted;
+}
+
+STATIC bool ndarray_mask_strides(ndarray_obj_t *ndarray, ndarray_obj_t *mask, int32_t *strides) {
+    // A Boolean mask either has the shape of ndarray, and then it selects single elements, or it is 
+    // linear, and as long as the first axis of a matrix, or higher dimensional array; in the latter 
+    // case, it selects along the first axis, and it is broadcast along all the others. 
+    // The function fills strides, with which the mask can be walked along with ndarray, 
+    // and returns true, if the mask selects along the first axis
+    bool same_shape = true;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        strides[i] = mask->strides[i];
+        if(mask->shape[i] != ndarray->shape[i]) {
+            same_shape = false;
+        }
+    }
+    if(same_shape) {
+        return false;
+    }
+    uint8_t axis = ULAB_MAX_DIMS - ndarray->ndim;
+    if((mask->ndim != 2) || (ROWS(mask) != 1) || (COLUMNS(mask) != ndarray->shape[axis]) || 
+      ((ndarray->ndim == 2) && (ROWS(ndarray) == 1))) {
+        mp_raise_msg(&mp_type_IndexError, "Boolean index does not match the shape of the array");
+    }
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        strides[i] = 0;
+    }
+    strides[axis] = mask->strides[ULAB_MAX_DIMS-1];
+    return true;
+}
+
+STATIC void ndarray_mask_gather(ndarray_obj_t *ndarray, ndarray_obj_t *mask, int32_t *mstrides, ndarray_obj_t *out) {
+    // copies the elements of ndarray, where mask is True, into the dense array out
+    uint8_t _sizeof = ndarray_itemsize(ndarray->array->typecode);
+    if(_sizeof == 1) {
+        MASK_GATHER(uint8_t, ndarray, mask, mstrides, out);
+    } else if(_sizeof == 2) {
+        MASK_GATHER(uint16_t, ndarray, mask, mstrides, out);
+    } else if(_sizeof == 4) {
+        MASK_GATHER(uint32_t, ndarray, mask, mstrides, out);
+    } else if(_sizeof == 8) {
+        MASK_GATHER(uint64_t, ndarray, mask, mstrides, out);
+    } else {
+        MASK_GATHER(ndarray_complex_t, ndarray, mask, mstrides, out);
+    }
+}
+
+STATIC void ndarray_mask_scatter(ndarray_obj_t *ndarray, ndarray_obj_t *mask, int32_t *mstrides, ndarray_obj_t *values, uint8_t vstep) {
+    // writes the elements of the dense array values, which has the type of ndarray, where mask is True
+    uint8_t _sizeof = ndarray_itemsize(ndarray->array->typecode);
+    if(_sizeof == 1) {
+        MASK_SCATTER(uint8_t, ndarray, mask, mstrides, values, vstep);
+    } else if(_sizeof == 2) {
+        MASK_SCATTER(uint16_t, ndarray, mask, mstrides, values, vstep);
+    } else if(_sizeof == 4) {
+        MASK_SCATTER(uint32_t, ndarray, mask, mstrides, values, vstep);
+    } else if(_sizeof == 8) {
+        MASK_SCATTER(uint64_t, ndarray, mask, mstrides, values, vstep);
+    } else {
+        MASK_SCATTER(ndarray_complex_t, ndarray, mask, mstrides, values, vstep);
+    }
+}
+
+STATIC mp_obj_t ndarray_get_masked(ndarray_obj_t *ndarray, ndarray_obj_t *mask, ndarray_obj_t *values) {
+    // returns the elements of ndarray, where mask is True, or, if values is not NULL, 
+    // assigns values to them. Single elements result in a linear array, while a mask along 
+    // the first axis keeps the selected sub-arrays. The elements are moved in the largest 
+    // unsigned type that has the size of an element, there is no need to look at the typecode
+    int32_t mstrides[ULAB_MAX_DIMS];
+    bool along_axis = ndarray_mask_strides(ndarray, mask, mstrides);
+    size_t trues = 0;
+    NDARRAY_LOOP(mask->shape, uint8_t, m, mask->items, mask->strides, trues += (*m != 0));
+    // a selected sub-array along the first axis contributes this many elements
+    size_t block = along_axis ? ndarray->len / ndarray->shape[ULAB_MAX_DIMS-ndarray->ndim] : 1;
+    if(values == NULL) {
+        ndarray_obj_t *out;
+        if(along_axis) {
+            size_t shape[ULAB_MAX_DIMS];
+            for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+                shape[i] = ndarray->shape[i];
+            }
+            shape[ULAB_MAX_DIMS-ndarray->ndim] = trues;
+            out = ndarray_new_empty(ndarray->ndim, shape, ndarray->array->typecode);
+        } else {
+            out = create_empty_ndarray(1, trues, ndarray->array->typecode);
+        }
+        out->boolean = ndarray->boolean;
+        ndarray_mask_gather(ndarray, mask, mstrides, out);
+        return MP_OBJ_FROM_PTR(out);
+    }
+    if((values->len != 1) && (values->len != trues * block)) {
+        mp_raise_ValueError("could not broadast input array from shape");
+    }
+    values = ndarray_values_like(ndarray, values);
+    ndarray_mask_scatter(ndarray, mask, mstrides, values, (values->len == 1) ? 0 : 1);
+    return mp_const_none;
+}
+
+STATIC mp_obj_t ndarray_get_masked_2d(ndarray_obj_t *ndarray, mp_obj_t *index, ndarray_obj_t *values) {
+    // indexes a matrix by a pair, in which at least one of the indices is a Boolean array, and the 
+    // other one is a Boolean array, an integer, or a slice. The integer, or slice is turned into a view, 
+    // and the bytes of the masks are walked along with that, so that no Boolean list has to be created
+    uint8_t _sizeof = ndarray_itemsize(ndarray->array->typecode);
+    ndarray_obj_t view = *ndarray;
+    ndarray_obj_t *masks[2] = { NULL, NULL };
+    size_t lengths[2];
+    int32_t mstrides[ULAB_MAX_DIMS] = { 0 };
+    for(uint8_t i=0; i < 2; i++) {
+        uint8_t axis = ULAB_MAX_DIMS - 2 + i;
+        if(MP_OBJ_IS_TYPE(index[i], &ulab_ndarray_type)) {
+            masks[i] = MP_OBJ_TO_PTR(index[i]);
+            mstrides[axis] = masks[i]->strides[ULAB_MAX_DIMS-1];
+            lengths[i] = 0;
+            uint8_t *m = (uint8_t *)masks[i]->items;
+            for(size_t j=0; j < COLUMNS(masks[i]); j++, m += mstrides[axis]) {
+                lengths[i] += (*m != 0);
+            }
+        } else {
+            mp_bound_slice_t slice = generate_slice(ndarray->shape[axis], index[i]);
+            lengths[i] = slice_length(slice);
+            if(lengths[i] == 0) {
+                mp_raise_msg(&mp_type_IndexError, "empty index range");
+            }
+            view.items = (uint8_t *)view.items + slice.start * ndarray->strides[axis] * _sizeof;
+            view.shape[axis] = lengths[i];
+            view.strides[axis] = ndarray->strides[axis] * slice.step;
+        }
+    }
+    view.len = view.shape[ULAB_MAX_DIMS-2] * view.shape[ULAB_MAX_DIMS-1];
+    
+    ndarray_obj_t *out = NULL;
+    uint8_t vstep = 1;
+    if(values == NULL) {
+        out = create_empty_ndarray(lengths[0], lengths[1], ndarray->array->typecode);
+        out->boolean = ndarray->boolean;
+    } else {
+        if((values->len != 1) && ((values->len != lengths[0] * lengths[1]) || 
+           (ROWS(values) != lengths[0]) || (COLUMNS(values) != lengths[1]))) {
+            // values has to be broadcast into the selection first
+            ndarray_obj_t *dense = create_empty_ndarray(lengths[0], lengths[1], values->array->typecode);
+            dense->boolean = values->boolean;
+            ndarray_assign_view(dense, values);
+            values = dense;
+        }
+        out = ndarray_values_like(ndarray, values);
+        vstep = (out->len == 1) ? 0 : 1;
+    }
+    if((masks[0] == NULL) || (masks[1] == NULL)) {
+        // a single mask is broadcast along the other axis of the view
+        ndarray_obj_t *mask = (masks[0] == NULL) ? masks[1] : masks[0];
+        if(values == NULL) {
+            ndarray_mask_gather(&view, mask, mstrides, out);
+        } else {
+            ndarray_mask_scatter(&view, mask, mstrides, out, vstep);
+        }
+    } else {
+        // the row mask picks the rows, and the column mask is applied to each of them
+        ndarray_obj_t row = view, target = *out;
+        row.shape[ULAB_MAX_DIMS-2] = 1;
+        mstrides[ULAB_MAX_DIMS-2] = 0;
+        uint8_t *m = (uint8_t *)masks[0]->items;
+        for(size_t i=0; i < ROWS(ndarray); i++, m += masks[0]->strides[ULAB_MAX_DIMS-1]) {
+            if(*m) {
+                row.items = (uint8_t *)view.items + i * view.strides[ULAB_MAX_DIMS-2] * _sizeof;
+                if(values == NULL) {
+                    ndarray_mask_gather(&row, masks[1], mstrides, &target);
+                } else {
+                    ndarray_mask_scatter(&row, masks[1], mstrides, &target, vstep);
+                }
+                target.items = (uint8_t *)target.items + vstep * lengths[1] * _sizeof;
+            }
+        }
+    }
+    return (values == NULL) ? MP_OBJ_FROM_PTR(out) : mp_const_none;
+}
+
+STATIC void ndarray_copy_block(uint8_t _sizeof, size_t *shape, void *target, int32_t *tstrides, void *source, int32_t *sstrides) {
+    // copies a block of the given shape element by element; the strides are in units of _sizeof
+    if((shape[0] == 1) && (shape[1] == 1) && (shape[2] == 1) && (shape[3] == 1)) {
+        // the most frequent case: the indexed array is linear, so that there is a single element
+        if(_sizeof == 1) {
+            *(uint8_t *)target = *(uint8_t *)source;
+        } else if(_sizeof == 2) {
+            *(uint16_t *)target = *(uint16_t *)source;
+        } else if(_sizeof == 4) {
+            *(uint32_t *)target = *(uint32_t *)source;
+        } else if(_sizeof == 8) {
+            *(uint64_t *)target = *(uint64_t *)source;
+        } else {
+            *(ndarray_complex_t *)target = *(ndarray_complex_t *)source;
+        }
+    } else if(_sizeof == 1) {
+        NDARRAY_LOOP2(shape, uint8_t, t, target, tstrides, uint8_t, s, source, sstrides, *t = *s);
+    } else if(_sizeof == 2) {
+        NDARRAY_LOOP2(shape, uint16_t, t, target, tstrides, uint16_t, s, source, sstrides, *t = *s);
+    } else if(_sizeof == 4) {
+        NDARRAY_LOOP2(shape, uint32_t, t, target, tstrides, uint32_t, s, source, sstrides, *t = *s);
+    } else if(_sizeof == 8) {
+        NDARRAY_LOOP2(shape, uint64_t, t, target, tstrides, uint64_t, s, source, sstrides, *t = *s);
+    } else {
+        NDARRAY_LOOP2(shape, ndarray_complex_t, t, target, tstrides, ndarray_complex_t, s, source, sstrides, *t = *s);
+    }
+}
+
+STATIC void ndarray_check_indices(ndarray_obj_t *indices) {
+    if(NDARRAY_IS_FLOAT(indices->array->typecode) || (indices->array->typecode == NDARRAY_COMPLEX) || indices->boolean) {
+        mp_raise_msg(&mp_type_IndexError, "arrays used as indices must be of integer type");
+    }
+}
+
+STATIC size_t ndarray_index_value(uint8_t typecode, void *item, size_t n) {
+    // reads an index from an integer array, and converts it to a position on an axis of length n; 
+    // negative indices count from the end of the axis; uint32 indices are read as unsigned, 
+    // so that values beyond INT32_MAX are out of bounds, instead of wrapping around to negative
+    int64_t k = (typecode == NDARRAY_UINT32) ? (int64_t)*(uint32_t *)item : ndarray_get_int_value(typecode, item);
+    if(k < 0) {
+        k += (int64_t)n;
+    }
+    if((k < 0) || (k >= (int64_t)n)) {
+        mp_raise_msg(&mp_type_IndexError, "index is out of bounds");
+    }
+    return (size_t)k;
+}
+
+STATIC void ndarray_take_put(ndarray_obj_t *ndarray, uint8_t axis, ndarray_obj_t *indices, 
+                             uint8_t *other, int32_t *ostrides, int32_t ostep, bool put) {
+    // Walks through indices in C order, and copies the sub-array of ndarray at each index along axis 
+    // into other, or, if put is true, from other into ndarray. ostrides are the strides of other 
+    // within a sub-array, and other is advanced by ostep elements after each index
+    uint8_t _sizeof = ndarray_itemsize(ndarray->array->typecode);
+    uint8_t isize = ndarray_itemsize(indices->array->typecode);
+    size_t shape[ULAB_MAX_DIMS];
+    int32_t istrides[ULAB_MAX_DIMS];
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        shape[i] = ndarray->shape[i];
+        istrides[i] = indices->strides[i] * isize;
+    }
+    shape[axis] = 1;
+    NDARRAY_LOOP(indices->shape, uint8_t, idx, indices->items, istrides, 
+                 uint8_t *item = (uint8_t *)ndarray->items + 
+                        (int32_t)ndarray_index_value(indices->array->typecode, idx, ndarray->shape[axis]) * ndarray->strides[axis] * _sizeof;
+                 if(put) ndarray_copy_block(_sizeof, shape, item, ndarray->strides, other, ostrides); 
+                 else ndarray_copy_block(_sizeof, shape, other, ostrides, item, ndarray->strides); 
+                 other += ostep * _sizeof);
+}
+
+STATIC void ndarray_block_strides(ndarray_obj_t *ndarray, uint8_t axis, ndarray_obj_t *values, int32_t *strides) {
+    // fills the strides, with which the dense values are walked through in a sub-array of ndarray 
+    // along axis; a single value is repeated everywhere
+    int32_t stride = (values->len == 1) ? 0 : 1;
+    for(uint8_t i=ULAB_MAX_DIMS; i > 0; i--) {
+        strides[i-1] = stride;
+        if(i-1 != axis) {
+            stride *= ndarray->shape[i-1];
+        }
+    }
+}
+
+STATIC mp_obj_t ndarray_get_indexed(ndarray_obj_t *ndarray, ndarray_obj_t *indices, ndarray_obj_t *values) {
+    // Returns the sub-arrays along the first axis of ndarray (the elements of a linear array) at the 
+    // positions in the integer array indices, or, if values is not NULL, assigns values to them. 
+    // The result has the shape of indices, followed by the remaining axes of ndarray
+    ndarray_check_indices(indices);
+    bool linear = (ndarray->ndim == 2) && (ROWS(ndarray) == 1);
+    uint8_t axis = linear ? ULAB_MAX_DIMS-1 : ULAB_MAX_DIMS-ndarray->ndim;
+    uint8_t rest = linear ? 0 : ndarray->ndim-1;
+    uint8_t nindex = ((indices->ndim == 2) && (ROWS(indices) == 1)) ? 1 : indices->ndim;
+    size_t block = 1;
+    for(uint8_t i=axis+1; i < ULAB_MAX_DIMS; i++) {
+        block *= ndarray->shape[i];
+    }
+    if(values == NULL) {
+        if(nindex + rest > ULAB_MAX_DIMS) {
+            mp_raise_msg(&mp_type_IndexError, "too many dimensions");
+        }
+        size_t shape[ULAB_MAX_DIMS];
+        for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+            shape[i] = 1;
+        }
+        for(uint8_t i=0; i < nindex; i++) {
+            shape[ULAB_MAX_DIMS-rest-nindex+i] = indices->shape[ULAB_MAX_DIMS-nindex+i];
+        }
+        for(uint8_t i=0; i < rest; i++) {
+            shape[ULAB_MAX_DIMS-rest+i] = ndarray->shape[ULAB_MAX_DIMS-rest+i];
+        }
+        ndarray_obj_t *out = ndarray_new_empty(nindex+rest < 2 ? 2 : nindex+rest, shape, ndarray->array->typecode);
+        out->boolean = ndarray->boolean;
+        ndarray_take_put(ndarray, axis, indices, (uint8_t *)out->items, out->strides, block, false);
+        return MP_OBJ_FROM_PTR(out);
+    }
+    values = ndarray_values_like(ndarray, values);
+    if((values->len != 1) && (values->len != indices->len * block)) {
+        mp_raise_ValueError("could not broadast input array from shape");
+    }
+    int32_t vstrides[ULAB_MAX_DIMS];
+    ndarray_block_strides(ndarray, axis, values, vstrides);
+    ndarray_take_put(ndarray, axis, indices, (uint8_t *)values->items, vstrides, (values->len == 1) ? 0 : block, true);
+    return mp_const_none;
+}
+
+STATIC ndarray_obj_t *ndarray_flat_view(ndarray_obj_t *ndarray) {
+    // returns a linear view of the dense ndarray
+    size_t shape[ULAB_MAX_DIMS] = {1, 1, 1, ndarray->len};
+    int32_t strides[ULAB_MAX_DIMS] = {0, 0, 0, 1};
+    return ndarray_new_view(ndarray, 2, shape, strides, 0);
+}
+
+mp_obj_t ndarray_take(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+        { MP_QSTR_axis, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    
+    if(!mp_obj_is_type(args[0].u_obj, &ulab_ndarray_type) || !mp_obj_is_type(args[1].u_obj, &ulab_ndarray_type)) {
+        mp_raise_TypeError("input arguments must be ndarrays");
+    }
+    ndarray_obj_t *ndarray = MP_OBJ_TO_PTR(args[0].u_obj);
+    ndarray_obj_t *indices = MP_OBJ_TO_PTR(args[1].u_obj);
+    ndarray_check_indices(indices);
+    if(args[2].u_obj == mp_const_none) {
+        // the elements are taken from the flattened array, and the result has the shape of indices
+        ndarray = ndarray_flat_view(ndarray_contiguous(ndarray));
+        ndarray_obj_t *out = ndarray_new_empty(indices->ndim, indices->shape, ndarray->array->typecode);
+        out->boolean = ndarray->boolean;
+        ndarray_take_put(ndarray, ULAB_MAX_DIMS-1, indices, (uint8_t *)out->items, out->strides, 1, false);
+        return MP_OBJ_FROM_PTR(out);
+    }
+    uint8_t axis = ndarray_normalise_axis(ndarray, args[2].u_obj);
+    if((indices->ndim != 2) || (ROWS(indices) != 1)) {
+        mp_raise_ValueError("indices must be a linear array, if the axis is given");
+    }
+    size_t shape[ULAB_MAX_DIMS];
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        shape[i] = ndarray->shape[i];
+    }
+    shape[axis] = indices->len;
+    ndarray_obj_t *out = ndarray_new_empty(ndarray->ndim, shape, ndarray->array->typecode);
+    out->boolean = ndarray->boolean;
+    ndarray_take_put(ndarray, axis, indices, (uint8_t *)out->items, out->strides, out->strides[axis], false);
+    return MP_OBJ_FROM_PTR(out);
+}
+
+mp_obj_t ndarray_put(mp_obj_t a, mp_obj_t ind, mp_obj_t v) {
+    // replaces the elements of the flattened array a at the positions ind by the values v; 
+    // if there are fewer values than indices, the values are repeated
+    if(!mp_obj_is_type(a, &ulab_ndarray_type) || !mp_obj_is_type(ind, &ulab_ndarray_type)) {
+        mp_raise_TypeError("input arguments must be ndarrays");
+    }
+    ndarray_obj_t *ndarray = MP_OBJ_TO_PTR(a);
+    ndarray_obj_t *indices = MP_OBJ_TO_PTR(ind);
+    ndarray_check_indices(indices);
+    if(!ndarray_is_dense(ndarray)) {
+        mp_raise_ValueError("array must be contiguous");
+    }
+    ndarray_obj_t *values = ndarray_values_like(ndarray, ndarray_assignment_values(ndarray, v));
+    if(values->len == 0) {
+        mp_raise_ValueError("values must not be empty");
+    }
+    if((values->len != 1) && (values->len != indices->len)) {
+        ndarray_obj_t *repeated = create_empty_ndarray(1, indices->len, ndarray->array->typecode);
+        uint8_t _sizeof = ndarray_itemsize(ndarray->array->typecode);
+        for(size_t i=0; i < indices->len; i++) {
+            memcpy((uint8_t *)repeated->items + i*_sizeof, (uint8_t *)values->items + (i % values->len)*_sizeof, _sizeof);
+        }
+        values = repeated;
+    }
+    int32_t vstrides[ULAB_MAX_DIMS] = {0, 0, 0, 0};
+    ndarray_take_put(ndarray_flat_view(ndarray), ULAB_MAX_DIMS-1, indices, (uint8_t *)values->items, vstrides, 
+                     (values->len == 1) ? 0 : 1, true);
+    return mp_const_none;
+}
+
+#define TAKE_ALONG_AXIS(type, ndarray, indices, istrides, sstrides, axis, out) do {\
+    type *_o = (type *)(out)->items;\
+    int32_t _stride = (ndarray)->strides[(axis)];\
+    NDARRAY_LOOP2((indices)->shape, uint8_t, idx, (indices)->items, (istrides), type, s, (ndarray)->items, (sstrides), \
+                  *_o++ = s[(int32_t)ndarray_index_value((indices)->array->typecode, idx, (ndarray)->shape[(axis)]) * _stride]);\
+} while(0)
+
+mp_obj_t ndarray_take_along_axis(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+        { MP_QSTR_axis, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    
+    if(!mp_obj_is_type(args[0].u_obj, &ulab_ndarray_type) || !mp_obj_is_type(args[1].u_obj, &ulab_ndarray_type)) {
+        mp_raise_TypeError("input arguments must be ndarrays");
+    }
+    ndarray_obj_t *ndarray = MP_OBJ_TO_PTR(args[0].u_obj);
+    ndarray_obj_t *indices = MP_OBJ_TO_PTR(args[1].u_obj);
+    ndarray_check_indices(indices);
+    uint8_t axis;
+    if(args[2].u_obj == mp_const_none) {
+        // the array is flattened, as in take
+        ndarray = ndarray_flat_view(ndarray_contiguous(ndarray));
+        axis = ULAB_MAX_DIMS-1;
+    } else {
+        axis = ndarray_normalise_axis(ndarray, args[2].u_obj);
+    }
+    // the indices pick a single element along axis at each position of all the other axes
+    if(indices->ndim != ndarray->ndim) {
+        mp_raise_ValueError("indices must have the same number of dimensions as the array");
+    }
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        if((i != axis) && (indices->shape[i] != ndarray->shape[i])) {
+            mp_raise_ValueError("shape mismatch: indices, and array could not be broadcast together");
+        }
+    }
+    ndarray_obj_t *out = ndarray_new_empty(indices->ndim, indices->shape, ndarray->array->typecode);
+    out->boolean = ndarray->boolean;
+    uint8_t _sizeof = ndarray_itemsize(ndarray->array->typecode);
+    uint8_t isize = ndarray_itemsize(indices->array->typecode);
+    int32_t istrides[ULAB_MAX_DIMS], sstrides[ULAB_MAX_DIMS];
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        istrides[i] = indices->strides[i] * isize;
+        sstrides[i] = ndarray->strides[i];
+    }
+    // the position along axis is given by the index, and not by the loop
+    sstrides[axis] = 0;
+    if(_sizeof == 1) {
+        TAKE_ALONG_AXIS(uint8_t, ndarray, indices, istrides, sstrides, axis, out);
+    } else if(_sizeof == 2) {
+        TAKE_ALONG_AXIS(uint16_t, ndarray, indices, istrides, sstrides, axis, out);
+    } else if(_sizeof == 4) {
+        TAKE_ALONG_AXIS(uint32_t, ndarray, indices, istrides, sstrides, axis, out);
+    } else if(_sizeof == 8) {
+        TAKE_ALONG_AXIS(uint64_t, ndarray, indices, istrides, sstrides, axis, out);
+    } else {
+        TAKE_ALONG_AXIS(ndarray_complex_t, ndarray, indices, istrides, sstrides, axis, out);
+    }
+    return MP_OBJ_FROM_PTR(out);
+}
+
+mp_obj_t ndarray_get_slice(ndarray_obj_t *ndarray, mp_obj_t index, ndarray_obj_t *values) {
+    if(MP_OBJ_IS_TYPE(index, &ulab_ndarray_type)) {
+        ndarray_obj_t *indices = MP_OBJ_TO_PTR(index);
+        if(indices->boolean) {
+            return ndarray_get_masked(ndarray, indices, values);
+        }
+        return ndarray_get_indexed(ndarray, indices, values);
+    }
+    if(ndarray->ndim > 2) {
+        return ndarray_get_slice_nd(ndarray, index, values);
+    }
+    mp_bound_slice_t row_slice = simple_slice(0, 0, 1), column_slice = simple_slice(0, 0, 1);
+
+    size_t m = 0, n = 0;
+    if(mp_obj_is_int(index) && (ROWS(ndarray) == 1) && (values == NULL)) { 
+        // we have a row vector, and don't want to assign
+        column_slice = generate_slice(COLUMNS(ndarray), index);
+        if(slice_length(column_slice) == 1) { // we were asked for a single item
+            // subscribe returns an mp_obj_t, if and only, if the index is an integer, and we have a row vector
+            uint8_t *item = (uint8_t *)ndarray->items + 
+                            ndarray_index(ndarray, 0, column_slice.start) * ndarray_itemsize(ndarray->array->typecode);
+            return ndarray_get_item(ndarray, item);
         }
     }
     
     if(mp_obj_is_int(index) || MP_OBJ_IS_TYPE(index, &mp_type_slice)) {
-        if(ndarray->m == 1) { // we have a row vector
-            column_slice = generate_slice(ndarray->n, index);
+        if(ROWS(ndarray) == 1) { // we have a row vector
+            column_slice = generate_slice(COLUMNS(ndarray), index);
             row_slice = simple_slice(0, 1, 1);
         } else { // we have a matrix
-            row_slice = generate_slice(ndarray->m, index);
-            column_slice = simple_slice(0, ndarray->n, 1); // take all columns
+            row_slice = generate_slice(ROWS(ndarray), index);
+            column_slice = simple_slice(0, COLUMNS(ndarray), 1); // take all columns
         }
         m = slice_length(row_slice);
         n = slice_length(column_slice);
         return iterate_slice_list(ndarray, m, n, row_slice, column_slice, mp_const_none, mp_const_none, values);
     } else if(MP_OBJ_IS_TYPE(index, &mp_type_list)) {
         n = true_length(index);
-        if(ndarray->m == 1) { // we have a flat array
+        if(ROWS(ndarray) == 1) { // we have a flat array
             // we might have to separate the n == 1 case
             row_slice = simple_slice(0, 1, 1);
             return iterate_slice_list(ndarray, 1, n, row_slice, column_slice, mp_const_none, index, values);
@@ -512,21 +1809,21 @@ mp_obj_t ndarray_get_slice(ndarray_obj_t *ndarray, mp_obj_t index, ndarray_obj_t
                 return iterate_slice_list(ndarray, m, n, row_slice, column_slice, 
                                           tuple->items[0], tuple->items[1], values);
             } else { // the column is indexed by an integer, or a slice
-                column_slice = generate_slice(ndarray->n, tuple->items[1]);
+                column_slice = generate_slice(COLUMNS(ndarray), tuple->items[1]);
                 n = slice_length(column_slice);
                 return iterate_slice_list(ndarray, m, n, row_slice, column_slice, 
                                           tuple->items[0], mp_const_none, values);
             }
             
         } else { // rows are indexed by a slice, or an integer
-            row_slice = generate_slice(ndarray->m, tuple->items[0]);
+            row_slice = generate_slice(ROWS(ndarray), tuple->items[0]);
             m = slice_length(row_slice);
             if(MP_OBJ_IS_TYPE(tuple->items[1], &mp_type_list)) { // columns are indexed by a Boolean list
                 n = true_length(tuple->items[1]);
                 return iterate_slice_list(ndarray, m, n, row_slice, column_slice, 
                                          mp_const_none, tuple->items[1], values);
             } else { // columns are indexed by an integer, or a slice
-                column_slice = generate_slice(ndarray->n, tuple->items[1]);
+                column_slice = generate_slice(COLUMNS(ndarray), tuple->items[1]);
                 n = slice_length(column_slice);
                 return iterate_slice_list(ndarray, m, n, row_slice, column_slice, 
                                           mp_const_none, mp_const_none, values);             
@@ -538,28 +1835,47 @@ mp_obj_t ndarray_get_slice(ndarray_obj_t *ndarray, mp_obj_t index, ndarray_obj_t
 
 mp_obj_t ndarray_subscr(mp_obj_t self_in, mp_obj_t index, mp_obj_t value) {
     ndarray_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if(MP_OBJ_IS_TYPE(index, &mp_type_tuple)) {
+        // in a tuple of indices, Boolean arrays, e.g., the results of comparisons, 
+        // select along the axis that they index
+        mp_obj_tuple_t *tuple = MP_OBJ_TO_PTR(index);
+        size_t masks = 0, others = 0;
+        for(size_t i=0; i < tuple->len; i++) {
+            if(MP_OBJ_IS_TYPE(tuple->items[i], &ulab_ndarray_type) && 
+               ((ndarray_obj_t *)MP_OBJ_TO_PTR(tuple->items[i]))->boolean) {
+                // the mask must be a linear array, as long as the axis that it indexes
+                ndarray_obj_t *mask = MP_OBJ_TO_PTR(tuple->items[i]);
+                if((mask->ndim != 2) || (ROWS(mask) != 1) || (i >= self->ndim) || 
+                   (COLUMNS(mask) != self->shape[ULAB_MAX_DIMS - self->ndim + i])) {
+                    mp_raise_msg(&mp_type_IndexError, "Boolean index does not match the shape of the array");
+                }
+                masks++;
+            } else if(mp_obj_is_int(tuple->items[i]) || MP_OBJ_IS_TYPE(tuple->items[i], &mp_type_slice)) {
+                others++;
+            }
+        }
+        if(masks && (self->ndim == 2) && (tuple->len == 2) && (masks + others == 2)) {
+            if(value == MP_OBJ_SENTINEL) {
+                return ndarray_get_masked_2d(self, tuple->items, NULL);
+            }
+            return ndarray_get_masked_2d(self, tuple->items, ndarray_assignment_values(self, value));
+        }
+        // in all other cases, the masks are taken as Boolean lists
+        for(size_t i=0; masks && (i < tuple->len); i++) {
+            if(MP_OBJ_IS_TYPE(tuple->items[i], &ulab_ndarray_type) && 
+               ((ndarray_obj_t *)MP_OBJ_TO_PTR(tuple->items[i]))->boolean) {
+                tuple = MP_OBJ_TO_PTR(mp_obj_new_tuple(tuple->len, tuple->items));
+                index = MP_OBJ_FROM_PTR(tuple);
+                tuple->items[i] = ndarray_bool_list(MP_OBJ_TO_PTR(tuple->items[i]));
+            }
+        }
+    }
     
     if (value == MP_OBJ_SENTINEL) { // return value(s)
         return ndarray_get_slice(self, index, NULL);    
-    } else { // assignment to slices; the value must be an ndarray, or a scalar
-        if(!MP_OBJ_IS_TYPE(value, &ulab_ndarray_type) && 
-          !mp_obj_is_int(value) && !mp_obj_is_float(value)) {
-            mp_raise_ValueError("right hand side must be an ndarray, or a scalar");
-        } else {
-            ndarray_obj_t *values = NULL;
-            if(mp_obj_is_int(value)) {
-                values = create_new_ndarray(1, 1, self->array->typecode);
-                mp_binary_set_val_array(values->array->typecode, values->array->items, 0, value);   
-            } else if(mp_obj_is_float(value)) {
-                values = create_new_ndarray(1, 1, NDARRAY_FLOAT);
-                mp_binary_set_val_array(NDARRAY_FLOAT, values->array->items, 0, value);
-            } else {
-                values = MP_OBJ_TO_PTR(value);
-            }
-            return ndarray_get_slice(self, index, values);
-        }
-    }      
-    return mp_const_none;
+    }
+    // assignment to slices
+    return ndarray_get_slice(self, index, ndarray_assignment_values(self, value));
 }
 
 // itarray iterator
@@ -580,24 +1896,27 @@ mp_obj_t ndarray_iternext(mp_obj_t self_in) {
     ndarray_obj_t *ndarray = MP_OBJ_TO_PTR(self->ndarray);
     // TODO: in numpy, ndarrays are iterated with respect to the first axis. 
     size_t iter_end = 0;
-    if(ndarray->m == 1) {
-        iter_end = ndarray->array->len;
+    if(ndarray->ndim > 2) {
+        iter_end = ndarray->shape[ULAB_MAX_DIMS-ndarray->ndim];
+    } else if(ROWS(ndarray) == 1) {
+        iter_end = COLUMNS(ndarray);
     } else {
-        iter_end = ndarray->m;
+        iter_end = ROWS(ndarray);
     }
     if(self->cur < iter_end) {
-        if(ndarray->n == ndarray->array->len) { // we have a linear array
-            // read the current value
-            mp_obj_t value;
-            value = mp_binary_get_val_array(ndarray->array->typecode, ndarray->array->items, self->cur);
+        if(ndarray->ndim > 2) { // return the sub-arrays along the first axis as views
+            mp_obj_t value = ndarray_get_slice_nd(ndarray, MP_OBJ_NEW_SMALL_INT(self->cur), NULL);
             self->cur++;
             return value;
-        } else { // we have a matrix, return the number of rows
-            ndarray_obj_t *value = create_new_ndarray(1, ndarray->n, ndarray->array->typecode);
-            // copy the memory content here
-            uint8_t *tmp = (uint8_t *)ndarray->array->items;
-            size_t strip_size = ndarray->n * mp_binary_get_size('@', ndarray->array->typecode, NULL);
-            memcpy(value->array->items, &tmp[self->cur*strip_size], strip_size);
+        } else if(ROWS(ndarray) == 1) { // we have a linear array
+            // read the current value
+            uint8_t *item = (uint8_t *)ndarray->items + 
+                            ndarray_index(ndarray, 0, self->cur) * ndarray_itemsize(ndarray->array->typecode);
+            self->cur++;
+            return ndarray_get_item(ndarray, item);
+        } else { // we have a matrix, return the rows as views
+            mp_obj_t value = iterate_slice_list(ndarray, 1, COLUMNS(ndarray), simple_slice(self->cur, self->cur+1, 1), 
+                                                simple_slice(0, COLUMNS(ndarray), 1), mp_const_none, mp_const_none, NULL);
             self->cur++;
             return value;
         }
@@ -618,31 +1937,212 @@ mp_obj_t mp_obj_new_ndarray_iterator(mp_obj_t ndarray, size_t cur, mp_obj_iter_b
 
 mp_obj_t ndarray_shape(mp_obj_t self_in) {
     ndarray_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    mp_obj_t tuple[2] = {
-        mp_obj_new_int(self->m),
-        mp_obj_new_int(self->n)
-    };
-    return mp_obj_new_tuple(2, tuple);
+    mp_obj_t tuple[ULAB_MAX_DIMS];
+    for(uint8_t i=0; i < self->ndim; i++) {
+        tuple[i] = mp_obj_new_int(self->shape[ULAB_MAX_DIMS-self->ndim+i]);
+    }
+    return mp_obj_new_tuple(self->ndim, tuple);
 }
 
 mp_obj_t ndarray_rawsize(mp_obj_t self_in) {
     // returns a 5-tuple with the 
     // 
-    // 0. number of rows
+    // 0. number of rows (the product of the lengths of all axes but the last one)
     // 1. number of columns
-    // 2. length of the storage (should be equal to the product of 1. and 2.)
+    // 2. number of elements (should be equal to the product of 1. and 2.)
     // 3. length of the data storage in bytes
     // 4. datum size in bytes
     ndarray_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    size_t rows = 1;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS-1; i++) {
+        rows *= self->shape[i];
+    }
     mp_obj_tuple_t *tuple = MP_OBJ_TO_PTR(mp_obj_new_tuple(5, NULL));
-    tuple->items[0] = MP_OBJ_NEW_SMALL_INT(self->m);
-    tuple->items[1] = MP_OBJ_NEW_SMALL_INT(self->n);
-    tuple->items[2] = MP_OBJ_NEW_SMALL_INT(self->array->len);
+    tuple->items[0] = MP_OBJ_NEW_SMALL_INT(rows);
+    tuple->items[1] = MP_OBJ_NEW_SMALL_INT(COLUMNS(self));
+    tuple->items[2] = MP_OBJ_NEW_SMALL_INT(self->len);
     tuple->items[3] = MP_OBJ_NEW_SMALL_INT(self->bytes);
-    tuple->items[4] = MP_OBJ_NEW_SMALL_INT(mp_binary_get_size('@', self->array->typecode, NULL));
+    tuple->items[4] = MP_OBJ_NEW_SMALL_INT(ndarray_itemsize(self->array->typecode));
     return tuple;
 }
 
+STATIC void ndarray_dtype_range(uint8_t typecode, bool boolean, int64_t *min, int64_t *max) {
+    // the smallest, and largest values of an integer type; floats are not limited here
+    *min = 0;
+    *max = 0;
+    if(boolean) {
+        *max = 1;
+    } else if(typecode == NDARRAY_UINT8) {
+        *max = UINT8_MAX;
+    } else if(typecode == NDARRAY_INT8) {
+        *min = INT8_MIN;
+        *max = INT8_MAX;
+    } else if(typecode == NDARRAY_UINT16) {
+        *max = UINT16_MAX;
+    } else if(typecode == NDARRAY_INT16) {
+        *min = INT16_MIN;
+        *max = INT16_MAX;
+    } else if(typecode == NDARRAY_UINT32) {
+        *max = UINT32_MAX;
+    } else if(typecode == NDARRAY_INT32) {
+        *min = INT32_MIN;
+        *max = INT32_MAX;
+    }
+}
+
+STATIC bool ndarray_can_cast(ndarray_obj_t *ndarray, uint8_t dtype, bool boolean, qstr casting) {
+    // decides, whether the elements of ndarray can be converted to dtype according to the casting rule
+    if((casting != MP_QSTR_no) && (casting != MP_QSTR_equiv) && (casting != MP_QSTR_safe) && 
+       (casting != MP_QSTR_same_kind) && (casting != MP_QSTR_unsafe)) {
+        mp_raise_ValueError("casting must be one of 'no', 'equiv', 'safe', 'same_kind', or 'unsafe'");
+    }
+    uint8_t typecode = ndarray->array->typecode;
+    if((typecode == dtype) && (ndarray->boolean == boolean)) {
+        return true;
+    }
+    if((casting == MP_QSTR_no) || (casting == MP_QSTR_equiv)) {
+        return false;
+    }
+    if(casting == MP_QSTR_unsafe) {
+        return true;
+    }
+    if(ndarray->boolean) {
+        // Booleans can be represented by all types
+        return true;
+    }
+    if(dtype == NDARRAY_COMPLEX) {
+        // the real numbers are a subset of the complex numbers
+        return true;
+    }
+    if(boolean || (typecode == NDARRAY_COMPLEX) || (NDARRAY_IS_FLOAT(typecode) && !NDARRAY_IS_FLOAT(dtype))) {
+        return false;
+    }
+    if(casting == MP_QSTR_same_kind) {
+        return true;
+    }
+    if(dtype == NDARRAY_FLOAT) {
+        return true;
+    }
+    if(NDARRAY_IS_FLOAT32(dtype)) {
+        // float32 holds all 16-bit integers exactly, but neither 32-bit integers, nor doubles
+        return (typecode != NDARRAY_FLOAT) && (typecode != NDARRAY_UINT32) && (typecode != NDARRAY_INT32);
+    }
+    if(dtype == NDARRAY_FLOAT16) {
+        // the 11-bit mantissa of float16 holds the 8-bit integers only
+        return (typecode == NDARRAY_UINT8) || (typecode == NDARRAY_INT8);
+    }
+    // an integer type can be cast safely, if all of its values are in the range of dtype
+    int64_t min, max, tmin, tmax;
+    ndarray_dtype_range(typecode, false, &min, &max);
+    ndarray_dtype_range(dtype, false, &tmin, &tmax);
+    return (tmin <= min) && (max <= tmax);
+}
+
+#define ASTYPE_INTEGER(type_out, source, out, saturate, min, max, round_fun) do {\
+    if(saturate) {\
+        ASTYPE_DISPATCH(type_out, (source), (out), ((*a < (min)) ? (min) : ((*a > (max)) ? (max) : *a)), \
+                        ndarray_float_to_integer(*a, (round_fun), true, (min), (max)));\
+    } else {\
+        ASTYPE_DISPATCH(type_out, (source), (out), *a, ndarray_float_to_integer(*a, (round_fun), false, (min), (max)));\
+    }\
+} while(0)
+
+mp_obj_t ndarray_astype(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+        { MP_QSTR_dtype, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = NDARRAY_FLOAT } },
+        { MP_QSTR_casting, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_QSTR(MP_QSTR_unsafe)} },
+        { MP_QSTR_saturate, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = false} },
+        { MP_QSTR_rounding, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_QSTR(MP_QSTR_nearest)} },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    
+    ndarray_obj_t *source = MP_OBJ_TO_PTR(args[0].u_obj);
+    uint8_t dtype = args[1].u_int;
+    bool boolean = (dtype == NDARRAY_BOOL);
+    if(boolean) {
+        dtype = NDARRAY_UINT8;
+    }
+    if((dtype != NDARRAY_UINT8) && (dtype != NDARRAY_INT8) && (dtype != NDARRAY_UINT16) && 
+       (dtype != NDARRAY_INT16) && (dtype != NDARRAY_UINT32) && (dtype != NDARRAY_INT32) && 
+       !NDARRAY_IS_FLOAT(dtype) && (dtype != NDARRAY_COMPLEX)) {
+        mp_raise_TypeError("data type not understood");
+    }
+    if(!ndarray_can_cast(source, dtype, boolean, mp_obj_str_get_qstr(args[2].u_obj))) {
+        mp_raise_TypeError("cannot cast array data according to the casting rule");
+    }
+    mp_float_t (*round_fun)(mp_float_t);
+    qstr rounding = mp_obj_str_get_qstr(args[4].u_obj);
+    if(rounding == MP_QSTR_nearest) {
+        round_fun = ndarray_round_nearest;
+    } else if(rounding == MP_QSTR_trunc) {
+        round_fun = MICROPY_FLOAT_C_FUN(trunc);
+    } else if(rounding == MP_QSTR_floor) {
+        round_fun = MICROPY_FLOAT_C_FUN(floor);
+    } else if(rounding == MP_QSTR_ceil) {
+        round_fun = MICROPY_FLOAT_C_FUN(ceil);
+    } else {
+        mp_raise_ValueError("rounding must be one of 'nearest', 'trunc', 'floor', or 'ceil'");
+    }
+    return MP_OBJ_FROM_PTR(ndarray_convert(source, dtype, boolean, args[3].u_bool, round_fun));
+}
+
+ndarray_obj_t *ndarray_convert(ndarray_obj_t *source, uint8_t dtype, bool boolean, bool saturate, 
+                               mp_float_t (*round_fun)(mp_float_t)) {
+    // returns a dense copy of source with the given dtype; the elements are read in a single pass 
+    // through the strides, so source can be a view. dtype must not be NDARRAY_BOOL: Boolean 
+    // arrays are requested by boolean, and uint8 storage. Floats are rounded by round_fun, and 
+    // are clipped to the range of integer types, if saturate is true
+    if((source->array->typecode == dtype) && (source->boolean == boolean)) {
+        return MP_OBJ_TO_PTR(ndarray_copy(MP_OBJ_FROM_PTR(source)));
+    }
+    if(source->array->typecode == NDARRAY_COMPLEX) {
+        // the imaginary parts are discarded, and the real parts are converted as float
+        source = MP_OBJ_TO_PTR(ndarray_real(MP_OBJ_FROM_PTR(source)));
+        if(dtype == NDARRAY_FLOAT) {
+            return source;
+        }
+    }
+    ndarray_obj_t *out = ndarray_new_empty(source->ndim, source->shape, dtype);
+    out->boolean = boolean;
+    int64_t min, max;
+    ndarray_dtype_range(dtype, boolean, &min, &max);
+    if(boolean) {
+        ASTYPE_DISPATCH(uint8_t, source, out, *a != 0, *a != 0);
+    } else if(dtype == NDARRAY_COMPLEX) {
+        // the elements become the real parts, and the imaginary parts are 0
+        uint8_t _sizeof = ndarray_itemsize(source->array->typecode);
+        int32_t strides[ULAB_MAX_DIMS];
+        for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+            strides[i] = source->strides[i] * _sizeof;
+        }
+        mp_float_t *target = (mp_float_t *)out->items;
+        NDARRAY_LOOP(source->shape, uint8_t, a, source->items, strides, 
+                     ndarray_get_complex_value(a, source->array->typecode, 0, target, target+1); target += 2);
+    } else if(NDARRAY_IS_FLOAT32(dtype)) {
+        ASTYPE_DISPATCH(float, source, out, *a, *a);
+    } else if(dtype == NDARRAY_FLOAT16) {
+        ASTYPE_DISPATCH(uint16_t, source, out, ndarray_float_to_float16(*a), ndarray_float_to_float16(*a));
+    } else if(dtype == NDARRAY_FLOAT) {
+        ASTYPE_DISPATCH(mp_float_t, source, out, *a, *a);
+    } else if(dtype == NDARRAY_UINT8) {
+        ASTYPE_INTEGER(uint8_t, source, out, saturate, min, max, round_fun);
+    } else if(dtype == NDARRAY_INT8) {
+        ASTYPE_INTEGER(int8_t, source, out, saturate, min, max, round_fun);
+    } else if(dtype == NDARRAY_UINT16) {
+        ASTYPE_INTEGER(uint16_t, source, out, saturate, min, max, round_fun);
+    } else if(dtype == NDARRAY_INT16) {
+        ASTYPE_INTEGER(int16_t, source, out, saturate, min, max, round_fun);
+    } else if(dtype == NDARRAY_UINT32) {
+        ASTYPE_INTEGER(uint32_t, source, out, saturate, min, max, round_fun);
+    } else {
+        ASTYPE_INTEGER(int32_t, source, out, saturate, min, max, round_fun);
+    }
+    return out;
+}
+
 mp_obj_t ndarray_flatten(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_order, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_QSTR(MP_QSTR_C)} },
@@ -661,178 +2161,736 @@ mp_obj_t ndarray_flatten(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_a
     // if order == 'C', we simply have to set m, and n, there is nothing else to do
     if(memcmp(order, "F", 1) == 0) {
         ndarray_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
-        uint8_t _sizeof = mp_binary_get_size('@', self->array->typecode, NULL);
+        uint8_t _sizeof = ndarray_itemsize(self->array->typecode);
         // get the data of self_in: we won't need a temporary buffer for the transposition
-        uint8_t *self_array = (uint8_t *)self->array->items;
-        uint8_t *array = (uint8_t *)ndarray->array->items;
-        size_t i=0;
-        for(size_t n=0; n < self->n; n++) {
-            for(size_t m=0; m < self->m; m++) {
-                memcpy(array+_sizeof*i, self_array+_sizeof*(m*self->n + n), _sizeof);
-                i++;
-            }
-        }        
+        uint8_t *self_array = (uint8_t *)self->items;
+        uint8_t *array = (uint8_t *)ndarray->items;
+        // walk through self with the axes in reverse order
+        size_t shape[ULAB_MAX_DIMS];
+        int32_t strides[ULAB_MAX_DIMS];
+        for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+            shape[i] = self->shape[ULAB_MAX_DIMS-1-i];
+            strides[i] = self->strides[ULAB_MAX_DIMS-1-i] * _sizeof;
+        }
+        NDARRAY_LOOP(shape, uint8_t, a, self_array, strides, memcpy(array, a, _sizeof); array += _sizeof);
+    }
+    ndarray->ndim = 2;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS-1; i++) {
+        ndarray->shape[i] = 1;
+        ndarray->strides[i] = ndarray->len;
     }
-    ndarray->n = ndarray->array->len;
-    ndarray->m = 1;
+    ndarray->shape[ULAB_MAX_DIMS-1] = ndarray->len;
     return self_copy;
 }
 
 mp_obj_t ndarray_asbytearray(mp_obj_t self_in) {
     ndarray_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if((self->items != self->array->items) || (self->len != self->array->len) || !ndarray_is_dense(self)) {
+        // a view covers only a part of the storage, so we hand out a compact copy of its data
+        self = MP_OBJ_TO_PTR(ndarray_copy(self_in));
+    }
+    if(self->array->typecode == NDARRAY_FLOAT16) {
+        // micropython can't interpret half-precision floats, so their bits are handed out as uint16s
+        mp_obj_array_t *array = m_new_obj(mp_obj_array_t);
+        *array = *self->array;
+        array->typecode = NDARRAY_UINT16;
+        return MP_OBJ_FROM_PTR(array);
+    } else if(self->array->typecode == NDARRAY_COMPLEX) {
+        // complex numbers are handed out as the interleaved real, and imaginary parts
+        mp_obj_array_t *array = m_new_obj(mp_obj_array_t);
+        *array = *self->array;
+        array->typecode = NDARRAY_FLOAT;
+        array->len *= 2;
+        return MP_OBJ_FROM_PTR(array);
+    }
     return MP_OBJ_FROM_PTR(self->array);
 }
 
+mp_int_t ndarray_get_buffer(mp_obj_t self_in, mp_buffer_info_t *bufinfo, mp_uint_t flags) {
+    // exports the data of self, so that readinto, memoryview etc. can work on them directly; 
+    // the buffer is always writable, and the typecode is that of the ndarray, except for float16, 
+    // whose bits are exported as uint16s, and complex, whose parts are exported as floats
+    (void)flags;
+    ndarray_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if(!ndarray_is_dense(self)) {
+        // the elements of a strided view are not in a single block of memory
+        return 1;
+    }
+    if(self->items != self->array->items) {
+        // an offset view would hand out a pointer into the middle of a block; the consumer keeps 
+        // only that pointer, and the garbage collector doesn't recognise interior pointers, 
+        // so the storage could be freed, while the buffer is still in use
+        return 1;
+    }
+    bufinfo->buf = self->items;
+    bufinfo->len = self->bytes;
+    bufinfo->typecode = self->array->typecode;
+    if(self->array->typecode == NDARRAY_FLOAT16) {
+        bufinfo->typecode = NDARRAY_UINT16;
+    } else if(self->array->typecode == NDARRAY_COMPLEX) {
+        bufinfo->typecode = NDARRAY_FLOAT;
+    }
+    return 0;
+}
+
 // Binary operations
 
-mp_obj_t ndarray_binary_op(mp_binary_op_t op, mp_obj_t lhs, mp_obj_t rhs) {
-//    if(op == MP_BINARY_OP_REVERSE_ADD) {
- //       return ndarray_binary_op(MP_BINARY_OP_ADD, rhs, lhs);
-  //  }    
-    // One of the operands is a scalar
-    // TODO: conform to numpy with the upcasting
-    // TODO: implement in-place operators
-    mp_obj_t RHS = MP_OBJ_NULL;
-    bool rhs_is_scalar = true;
-    if(mp_obj_is_int(rhs)) {
-        int32_t ivalue = mp_obj_get_int(rhs);
-        if((ivalue > 0) && (ivalue < 256)) {
-            CREATE_SINGLE_ITEM(RHS, uint8_t, NDARRAY_UINT8, ivalue);
-        } else if((ivalue > 255) && (ivalue < 65535)) {
-            CREATE_SINGLE_ITEM(RHS, uint16_t, NDARRAY_UINT16, ivalue);
-        } else if((ivalue < 0) && (ivalue > -128)) {
-            CREATE_SINGLE_ITEM(RHS, int8_t, NDARRAY_INT8, ivalue);
-        } else if((ivalue < -127) && (ivalue > -32767)) {
-            CREATE_SINGLE_ITEM(RHS, int16_t, NDARRAY_INT16, ivalue);
-        } else { // the integer value clearly does not fit the ulab types, so move on to float
-            CREATE_SINGLE_ITEM(RHS, mp_float_t, NDARRAY_FLOAT, ivalue);
+STATIC mp_obj_t ndarray_binary_op_float16(mp_binary_op_t op, ndarray_obj_t *ol, ndarray_obj_t *or, 
+                                          uint8_t ndim, size_t *shape, ndarray_obj_t *target) {
+    // At least one of the operands is a float16. The elements are converted to mp_float_t, when 
+    // they are read, and the results are converted to the output type, when they are written, 
+    // so that there are no temporary arrays. float16 combined with float16, or an 8-bit integer 
+    // results in float16, with a 16-bit integer, or float32 in float32, and otherwise in float
+    uint8_t other = (ol->array->typecode == NDARRAY_FLOAT16) ? or->array->typecode : ol->array->typecode;
+    uint8_t typecode = NDARRAY_FLOAT;
+    if((other == NDARRAY_FLOAT16) || (other == NDARRAY_UINT8) || (other == NDARRAY_INT8)) {
+        typecode = NDARRAY_FLOAT16;
+    } else if((other == NDARRAY_UINT16) || (other == NDARRAY_INT16) || NDARRAY_IS_FLOAT32(other)) {
+        typecode = NDARRAY_FLOAT32;
+    }
+    int32_t lstrides[ULAB_MAX_DIMS], rstrides[ULAB_MAX_DIMS];
+    ndarray_broadcast_strides(ol, lstrides);
+    ndarray_broadcast_strides(or, rstrides);
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        lstrides[i] *= ndarray_itemsize(ol->array->typecode);
+        rstrides[i] *= ndarray_itemsize(or->array->typecode);
+    }
+    if((op == MP_BINARY_OP_ADD) || (op == MP_BINARY_OP_SUBTRACT) || 
+       (op == MP_BINARY_OP_MULTIPLY) || (op == MP_BINARY_OP_TRUE_DIVIDE)) {
+        ndarray_obj_t *out = ndarray_binary_output(ndim, shape, typecode, target);
+        size_t k = 0;
+        if(op == MP_BINARY_OP_ADD) {
+            CONVERTING_BINARY_LOOP(ol, or, lstrides, rstrides, shape, ndarray_set_float_value(out->items, typecode, k++, x + y));
+        } else if(op == MP_BINARY_OP_SUBTRACT) {
+            CONVERTING_BINARY_LOOP(ol, or, lstrides, rstrides, shape, ndarray_set_float_value(out->items, typecode, k++, x - y));
+        } else if(op == MP_BINARY_OP_MULTIPLY) {
+            CONVERTING_BINARY_LOOP(ol, or, lstrides, rstrides, shape, ndarray_set_float_value(out->items, typecode, k++, x * y));
+        } else {
+            CONVERTING_BINARY_LOOP(ol, or, lstrides, rstrides, shape, ndarray_set_float_value(out->items, typecode, k++, x / y));
         }
-    } else if(mp_obj_is_float(rhs)) {
-        mp_float_t fvalue = mp_obj_get_float(rhs);        
-        CREATE_SINGLE_ITEM(RHS, mp_float_t, NDARRAY_FLOAT, fvalue);
+        return MP_OBJ_FROM_PTR(out);
+    }
+    // comparisons result in a Boolean array, unless the results go into target
+    ndarray_obj_t *out = ndarray_binary_output(ndim, shape, NDARRAY_BOOL, target);
+    uint8_t *odata = (uint8_t *)out->items;
+    if(op == MP_BINARY_OP_LESS) {
+        CONVERTING_BINARY_LOOP(ol, or, lstrides, rstrides, shape, *odata++ = (x < y));
+    } else if(op == MP_BINARY_OP_LESS_EQUAL) {
+        CONVERTING_BINARY_LOOP(ol, or, lstrides, rstrides, shape, *odata++ = (x <= y));
+    } else if(op == MP_BINARY_OP_MORE) {
+        CONVERTING_BINARY_LOOP(ol, or, lstrides, rstrides, shape, *odata++ = (x > y));
+    } else if(op == MP_BINARY_OP_MORE_EQUAL) {
+        CONVERTING_BINARY_LOOP(ol, or, lstrides, rstrides, shape, *odata++ = (x >= y));
+    } else if(op == MP_BINARY_OP_EQUAL) {
+        CONVERTING_BINARY_LOOP(ol, or, lstrides, rstrides, shape, *odata++ = (x == y));
+    } else {
+        CONVERTING_BINARY_LOOP(ol, or, lstrides, rstrides, shape, *odata++ = (x != y));
+    }
+    return MP_OBJ_FROM_PTR(out);
+}
+
+STATIC mp_obj_t ndarray_binary_op_complex(mp_binary_op_t op, ndarray_obj_t *ol, ndarray_obj_t *or, 
+                                          uint8_t ndim, size_t *shape, ndarray_obj_t *target) {
+    // At least one of the operands is complex, and so is the result of the arithmetic operators; 
+    // the real operand is read as a complex number with 0 imaginary part
+    int32_t lstrides[ULAB_MAX_DIMS], rstrides[ULAB_MAX_DIMS];
+    ndarray_broadcast_strides(ol, lstrides);
+    ndarray_broadcast_strides(or, rstrides);
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        lstrides[i] *= ndarray_itemsize(ol->array->typecode);
+        rstrides[i] *= ndarray_itemsize(or->array->typecode);
+    }
+    if((op == MP_BINARY_OP_EQUAL) || (op == MP_BINARY_OP_NOT_EQUAL)) {
+        ndarray_obj_t *out = ndarray_binary_output(ndim, shape, NDARRAY_BOOL, target);
+        uint8_t *odata = (uint8_t *)out->items;
+        uint8_t equal = (op == MP_BINARY_OP_EQUAL);
+        COMPLEX_BINARY_LOOP(ol, or, lstrides, rstrides, shape, *odata++ = (((xr == yr) && (xi == yi)) == equal));
+        return MP_OBJ_FROM_PTR(out);
+    }
+    if((op != MP_BINARY_OP_ADD) && (op != MP_BINARY_OP_SUBTRACT) && 
+       (op != MP_BINARY_OP_MULTIPLY) && (op != MP_BINARY_OP_TRUE_DIVIDE)) {
+        mp_raise_TypeError("complex numbers can't be ordered");
+    }
+    ndarray_obj_t *out = ndarray_binary_output(ndim, shape, NDARRAY_COMPLEX, target);
+    mp_float_t *odata = (mp_float_t *)out->items;
+    if(op == MP_BINARY_OP_ADD) {
+        COMPLEX_BINARY_LOOP(ol, or, lstrides, rstrides, shape, *odata++ = xr + yr; *odata++ = xi + yi);
+    } else if(op == MP_BINARY_OP_SUBTRACT) {
+        COMPLEX_BINARY_LOOP(ol, or, lstrides, rstrides, shape, *odata++ = xr - yr; *odata++ = xi - yi);
+    } else if(op == MP_BINARY_OP_MULTIPLY) {
+        COMPLEX_BINARY_LOOP(ol, or, lstrides, rstrides, shape, *odata++ = xr*yr - xi*yi; *odata++ = xr*yi + xi*yr);
     } else {
-        RHS = rhs;
-        rhs_is_scalar = false;
-    }
-    //else 
-    if(mp_obj_is_type(lhs, &ulab_ndarray_type) && mp_obj_is_type(RHS, &ulab_ndarray_type)) { 
-        // next, the ndarray stuff
-        ndarray_obj_t *ol = MP_OBJ_TO_PTR(lhs);
-        ndarray_obj_t *or = MP_OBJ_TO_PTR(RHS);
-        if(!rhs_is_scalar && ((ol->m != or->m) || (ol->n != or->n))) {
+        COMPLEX_BINARY_LOOP(ol, or, lstrides, rstrides, shape, 
+                            mp_float_t norm = yr*yr + yi*yi; 
+                            *odata++ = (xr*yr + xi*yi) / norm; *odata++ = (xi*yr - xr*yi) / norm);
+    }
+    return MP_OBJ_FROM_PTR(out);
+}
+
+STATIC mp_obj_t ndarray_inplace_op(mp_binary_op_t op, ndarray_obj_t *ol, ndarray_obj_t *or) {
+    // The result is written into ol, if the upcasting rules of the binary operators 
+    // result in the type of ol. Otherwise, MP_OBJ_NULL is returned, and micropython 
+    // falls back to the normal operator, which creates a new ndarray
+    uint8_t ltype = ol->array->typecode, rtype = or->array->typecode;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        // the right hand side can be broadcast, but the shape of the result must be that of ol
+        if((or->shape[i] != ol->shape[i]) && (or->shape[i] != 1)) {
             mp_raise_ValueError("operands could not be broadcast together");
         }
-        // At this point, the operands should have the same shape
-        switch(op) {
-            case MP_BINARY_OP_EQUAL:
-                // Two arrays are equal, if their shape, typecode, and elements are equal
-                if((ol->m != or->m) || (ol->n != or->n) || (ol->array->typecode != or->array->typecode)) {
-                    return mp_const_false;
-                } else {
-                    size_t i = ol->bytes;
-                    uint8_t *l = (uint8_t *)ol->array->items;
-                    uint8_t *r = (uint8_t *)or->array->items;
-                    while(i) { // At this point, we can simply compare the bytes, the type is irrelevant
-                        if(*l++ != *r++) {
-                            return mp_const_false;
-                        }
-                        i--;
-                    }
-                    return mp_const_true;
-                }
-                break;
-            case MP_BINARY_OP_LESS:
-            case MP_BINARY_OP_LESS_EQUAL:
-            case MP_BINARY_OP_MORE:
-            case MP_BINARY_OP_MORE_EQUAL:
-            case MP_BINARY_OP_ADD:
-            case MP_BINARY_OP_SUBTRACT:
-            case MP_BINARY_OP_TRUE_DIVIDE:
-            case MP_BINARY_OP_MULTIPLY:
-                // TODO: I believe, this part can be made significantly smaller (compiled size)
-                // by doing only the typecasting in the large ifs, and moving the loops outside
-                // These are the upcasting rules
-                // float always becomes float
-                // operation on identical types preserves type
-                // uint8 + int8 => int16
-                // uint8 + int16 => int16
-                // uint8 + uint16 => uint16
-                // int8 + int16 => int16
-                // int8 + uint16 => uint16
-                // uint16 + int16 => float
-                // The parameters of RUN_BINARY_LOOP are 
-                // typecode of result, type_out, type_left, type_right, lhs operand, rhs operand, operator
-                if(ol->array->typecode == NDARRAY_UINT8) {
-                    if(or->array->typecode == NDARRAY_UINT8) {
-                        RUN_BINARY_LOOP(NDARRAY_UINT8, uint8_t, uint8_t, uint8_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_INT8) {
-                        RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, uint8_t, int8_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_UINT16) {
-                        RUN_BINARY_LOOP(NDARRAY_UINT16, uint16_t, uint8_t, uint16_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_INT16) {
-                        RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, uint8_t, int16_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_FLOAT) {
-                        RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, uint8_t, mp_float_t, ol, or, op);
-                    }
-                } else if(ol->array->typecode == NDARRAY_INT8) {
-                    if(or->array->typecode == NDARRAY_UINT8) {
-                        RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, int8_t, uint8_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_INT8) {
-                        RUN_BINARY_LOOP(NDARRAY_INT8, int8_t, int8_t, int8_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_UINT16) {
-                        RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, int8_t, uint16_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_INT16) {
-                        RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, int8_t, int16_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_FLOAT) {
-                        RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, int8_t, mp_float_t, ol, or, op);
-                    }                
-                } else if(ol->array->typecode == NDARRAY_UINT16) {
-                    if(or->array->typecode == NDARRAY_UINT8) {
-                        RUN_BINARY_LOOP(NDARRAY_UINT16, uint16_t, uint16_t, uint8_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_INT8) {
-                        RUN_BINARY_LOOP(NDARRAY_UINT16, uint16_t, uint16_t, int8_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_UINT16) {
-                        RUN_BINARY_LOOP(NDARRAY_UINT16, uint16_t, uint16_t, uint16_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_INT16) {
-                        RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, uint16_t, int16_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_FLOAT) {
-                        RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, uint8_t, mp_float_t, ol, or, op);
-                    }
-                } else if(ol->array->typecode == NDARRAY_INT16) {
-                    if(or->array->typecode == NDARRAY_UINT8) {
-                        RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, int16_t, uint8_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_INT8) {
-                        RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, int16_t, int8_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_UINT16) {
-                        RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, int16_t, uint16_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_INT16) {
-                        RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, int16_t, int16_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_FLOAT) {
-                        RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, uint16_t, mp_float_t, ol, or, op);
-                    }
-                } else if(ol->array->typecode == NDARRAY_FLOAT) {
-                    if(or->array->typecode == NDARRAY_UINT8) {
-                        RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, mp_float_t, uint8_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_INT8) {
-                        RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, mp_float_t, int8_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_UINT16) {
-                        RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, mp_float_t, uint16_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_INT16) {
-                        RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, mp_float_t, int16_t, ol, or, op);
-                    } else if(or->array->typecode == NDARRAY_FLOAT) {
-                        RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, mp_float_t, mp_float_t, ol, or, op);
-                    }
-                } else { // this should never happen
-                    mp_raise_TypeError("wrong input type");
-                }
-                // this instruction should never be reached, but we have to make the compiler happy
-                return MP_OBJ_NULL; 
-            default:
-                return MP_OBJ_NULL; // op not supported                                                        
+    }
+    if(((op == MP_BINARY_OP_INPLACE_TRUE_DIVIDE) && !NDARRAY_IS_FLOAT(ltype) && (ltype != NDARRAY_COMPLEX)) || ol->boolean) {
+        // the results of arithmetic on Booleans are not Booleans
+        return MP_OBJ_NULL;
+    }
+    or = ndarray_detach(or, ol);
+    if((ltype == NDARRAY_FLOAT16) && ndarray_is_dense(ol) && 
+       ((rtype == NDARRAY_FLOAT16) || (rtype == NDARRAY_UINT8) || (rtype == NDARRAY_INT8))) {
+        // the float16 kernel writes the results into ol, as if it were the out argument
+        return ndarray_binary_op_float16(op - MP_BINARY_OP_INPLACE_OR + MP_BINARY_OP_OR, ol, or, ol->ndim, ol->shape, ol);
+    }
+    if((ltype == NDARRAY_COMPLEX) && ndarray_is_dense(ol)) {
+        // any operand can be added to, subtracted from etc. a complex array
+        return ndarray_binary_op_complex(op - MP_BINARY_OP_INPLACE_OR + MP_BINARY_OP_OR, ol, or, ol->ndim, ol->shape, ol);
+    }
+    if(ltype == NDARRAY_UINT8) {
+        if(rtype == NDARRAY_UINT8) {
+            RUN_INPLACE_LOOP(uint8_t, uint8_t, ol, or, op);
+        }
+    } else if(ltype == NDARRAY_INT8) {
+        if(rtype == NDARRAY_INT8) {
+            RUN_INPLACE_LOOP(int8_t, int8_t, ol, or, op);
+        }
+    } else if(ltype == NDARRAY_UINT16) {
+        if(rtype == NDARRAY_UINT8) {
+            RUN_INPLACE_LOOP(uint16_t, uint8_t, ol, or, op);
+        } else if(rtype == NDARRAY_INT8) {
+            RUN_INPLACE_LOOP(uint16_t, int8_t, ol, or, op);
+        } else if(rtype == NDARRAY_UINT16) {
+            RUN_INPLACE_LOOP(uint16_t, uint16_t, ol, or, op);
+        }
+    } else if(ltype == NDARRAY_INT16) {
+        if(rtype == NDARRAY_UINT8) {
+            RUN_INPLACE_LOOP(int16_t, uint8_t, ol, or, op);
+        } else if(rtype == NDARRAY_INT8) {
+            RUN_INPLACE_LOOP(int16_t, int8_t, ol, or, op);
+        } else if(rtype == NDARRAY_INT16) {
+            RUN_INPLACE_LOOP(int16_t, int16_t, ol, or, op);
+        }
+    } else if(ltype == NDARRAY_UINT32) {
+        if(rtype == NDARRAY_UINT8) {
+            RUN_INPLACE_LOOP(uint32_t, uint8_t, ol, or, op);
+        } else if(rtype == NDARRAY_UINT16) {
+            RUN_INPLACE_LOOP(uint32_t, uint16_t, ol, or, op);
+        } else if(rtype == NDARRAY_UINT32) {
+            RUN_INPLACE_LOOP(uint32_t, uint32_t, ol, or, op);
+        }
+    } else if(ltype == NDARRAY_INT32) {
+        if(rtype == NDARRAY_UINT8) {
+            RUN_INPLACE_LOOP(int32_t, uint8_t, ol, or, op);
+        } else if(rtype == NDARRAY_INT8) {
+            RUN_INPLACE_LOOP(int32_t, int8_t, ol, or, op);
+        } else if(rtype == NDARRAY_UINT16) {
+            RUN_INPLACE_LOOP(int32_t, uint16_t, ol, or, op);
+        } else if(rtype == NDARRAY_INT16) {
+            RUN_INPLACE_LOOP(int32_t, int16_t, ol, or, op);
+        } else if(rtype == NDARRAY_INT32) {
+            RUN_INPLACE_LOOP(int32_t, int32_t, ol, or, op);
+        }
+    } else if(NDARRAY_IS_FLOAT32(ltype)) {
+        if(rtype == NDARRAY_UINT8) {
+            RUN_INPLACE_LOOP(float, uint8_t, ol, or, op);
+        } else if(rtype == NDARRAY_INT8) {
+            RUN_INPLACE_LOOP(float, int8_t, ol, or, op);
+        } else if(rtype == NDARRAY_UINT16) {
+            RUN_INPLACE_LOOP(float, uint16_t, ol, or, op);
+        } else if(rtype == NDARRAY_INT16) {
+            RUN_INPLACE_LOOP(float, int16_t, ol, or, op);
+        } else if(NDARRAY_IS_FLOAT32(rtype)) {
+            RUN_INPLACE_LOOP(float, float, ol, or, op);
+        }
+    } else if(ltype == NDARRAY_FLOAT) {
+        if(rtype == NDARRAY_UINT8) {
+            RUN_INPLACE_LOOP(mp_float_t, uint8_t, ol, or, op);
+        } else if(rtype == NDARRAY_INT8) {
+            RUN_INPLACE_LOOP(mp_float_t, int8_t, ol, or, op);
+        } else if(rtype == NDARRAY_UINT16) {
+            RUN_INPLACE_LOOP(mp_float_t, uint16_t, ol, or, op);
+        } else if(rtype == NDARRAY_INT16) {
+            RUN_INPLACE_LOOP(mp_float_t, int16_t, ol, or, op);
+        } else if(rtype == NDARRAY_UINT32) {
+            RUN_INPLACE_LOOP(mp_float_t, uint32_t, ol, or, op);
+        } else if(rtype == NDARRAY_INT32) {
+            RUN_INPLACE_LOOP(mp_float_t, int32_t, ol, or, op);
+        } else if(NDARRAY_IS_FLOAT32(rtype)) {
+            RUN_INPLACE_LOOP(mp_float_t, float, ol, or, op);
+        } else if(rtype == NDARRAY_FLOAT) {
+            RUN_INPLACE_LOOP(mp_float_t, mp_float_t, ol, or, op);
+        }
+    }
+    return MP_OBJ_NULL;
+}
+
+ndarray_obj_t *ndarray_binary_operand(mp_obj_t obj, ndarray_obj_t *scalar, mp_obj_array_t *array, mp_float_t *value) {
+    // Returns obj, if it is an ndarray. A number is stored in value, and is wrapped in scalar, 
+    // an ndarray of shape (1, 1); all three structures are supplied by the caller (on the stack), 
+    // so that a scalar operand never allocates memory on the heap. value must have room for 
+    // two mp_float_t, the parts of a complex number. The integer type is 
+    // the smallest one that can hold the value. NULL is returned for all other objects
+    if(mp_obj_is_type(obj, &ulab_ndarray_type)) {
+        return MP_OBJ_TO_PTR(obj);
+    }
+    uint8_t typecode;
+    if(mp_obj_is_int(obj)) {
+        mp_int_t ivalue = mp_obj_get_int(obj);
+        if((ivalue >= 0) && (ivalue <= 255)) {
+            typecode = NDARRAY_UINT8;
+            *(uint8_t *)value = (uint8_t)ivalue;
+        } else if((ivalue > 255) && (ivalue <= 65535)) {
+            typecode = NDARRAY_UINT16;
+            *(uint16_t *)value = (uint16_t)ivalue;
+        } else if((ivalue < 0) && (ivalue >= -128)) {
+            typecode = NDARRAY_INT8;
+            *(int8_t *)value = (int8_t)ivalue;
+        } else if((ivalue < -128) && (ivalue >= -32768)) {
+            typecode = NDARRAY_INT16;
+            *(int16_t *)value = (int16_t)ivalue;
+        } else if((ivalue > 65535) && ((uint64_t)ivalue <= UINT32_MAX)) {
+            typecode = NDARRAY_UINT32;
+            *(uint32_t *)value = (uint32_t)ivalue;
+        } else if((ivalue < -32768) && ((int64_t)ivalue >= INT32_MIN)) {
+            typecode = NDARRAY_INT32;
+            *(int32_t *)value = (int32_t)ivalue;
+        } else { // the integer value clearly does not fit the ulab types, so move on to float
+            typecode = NDARRAY_FLOAT;
+            *value = (mp_float_t)ivalue;
         }
+    } else if(mp_obj_is_float(obj)) {
+        typecode = NDARRAY_FLOAT;
+        *value = mp_obj_get_float(obj);
+    #if ULAB_HAS_COMPLEX
+    } else if(mp_obj_is_type(obj, &mp_type_complex)) {
+        typecode = NDARRAY_COMPLEX;
+        mp_obj_get_complex(obj, &value[0], &value[1]);
+    #endif
     } else {
+        return NULL;
+    }
+    array->base.type = &mp_type_array;
+    array->typecode = typecode;
+    array->free = 0;
+    array->len = 1;
+    array->items = value;
+    scalar->base.type = &ulab_ndarray_type;
+    scalar->ndim = 2;
+    scalar->boolean = 0;
+    scalar->len = 1;
+    scalar->array = array;
+    scalar->bytes = ndarray_itemsize(typecode);
+    scalar->items = value;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        scalar->shape[i] = 1;
+        scalar->strides[i] = 1;
+    }
+    return scalar;
+}
+
+STATIC void ndarray_scalar_type(mp_obj_array_t *array, ndarray_obj_t *other) {
+    // A number does not change the type of a float32, or float16 array, so that the result 
+    // doesn't take up more RAM; the value is rounded to the precision of the array.
+    // Non-negative scalars are stored as unsigned integers. If the other operand is signed, and 
+    // the value fits into the signed type of the same size, the scalar is taken as that type instead, 
+    // so that, e.g., int8_array + 1 remains int8 (and int8_array += 1 runs in place), and a scalar 
+    // beyond 16 bits next to a signed operand results in an integer
+    if(array->typecode == NDARRAY_COMPLEX) {
+        // a complex number makes the result complex
+        return;
+    }
+    if(NDARRAY_IS_FLOAT32(other->array->typecode) || (other->array->typecode == NDARRAY_FLOAT16)) {
+        mp_float_t value = ndarray_get_float_value(array->items, array->typecode, 0);
+        ndarray_set_float_value(array->items, other->array->typecode, 0, value);
+        array->typecode = other->array->typecode;
+    } else if((array->typecode == NDARRAY_UINT8) && (*(uint8_t *)array->items <= INT8_MAX) && 
+              (other->array->typecode == NDARRAY_INT8)) {
+        array->typecode = NDARRAY_INT8;
+    } else if((array->typecode == NDARRAY_UINT16) && (*(uint16_t *)array->items <= INT16_MAX) && 
+              ((other->array->typecode == NDARRAY_INT8) || (other->array->typecode == NDARRAY_INT16))) {
+        array->typecode = NDARRAY_INT16;
+    } else if((array->typecode == NDARRAY_UINT32) && (*(uint32_t *)array->items <= INT32_MAX) && 
+       ((other->array->typecode == NDARRAY_INT8) || (other->array->typecode == NDARRAY_INT16) || 
+        (other->array->typecode == NDARRAY_INT32))) {
+        array->typecode = NDARRAY_INT32;
+    }
+}
+
+STATIC mp_obj_t ndarray_binary_op_helper(mp_binary_op_t op, mp_obj_t lhs, mp_obj_t rhs, ndarray_obj_t *target) {
+    // target is the ndarray supplied in the out keyword argument of the arithmetic functions, 
+    // or NULL, if the result is to be written into a new ndarray
+    // One of the operands can be a scalar
+    // TODO: conform to numpy with the upcasting
+    ndarray_obj_t lscalar, rscalar;
+    mp_obj_array_t larray, rarray;
+    mp_float_t lvalue[2], rvalue[2];
+    ndarray_obj_t *ol = ndarray_binary_operand(lhs, &lscalar, &larray, lvalue);
+    ndarray_obj_t *or = ndarray_binary_operand(rhs, &rscalar, &rarray, rvalue);
+    if((ol == NULL) || (or == NULL)) {
+        if(((op >= MP_BINARY_OP_REVERSE_OR) && (op <= MP_BINARY_OP_REVERSE_POWER)) || 
+            (op == MP_BINARY_OP_EQUAL) || (op == MP_BINARY_OP_NOT_EQUAL)) {
+            // let micropython raise the TypeError for the original operator, or compare the objects
+            return MP_OBJ_NULL;
+        }
         mp_raise_TypeError("wrong operand type on the right hand side");
     }
+    if(ol == &lscalar) {
+        ndarray_scalar_type(&larray, or);
+    }
+    if(or == &rscalar) {
+        ndarray_scalar_type(&rarray, ol);
+    }
+    if((op == MP_BINARY_OP_REVERSE_ADD) || (op == MP_BINARY_OP_REVERSE_SUBTRACT) || 
+       (op == MP_BINARY_OP_REVERSE_MULTIPLY) || (op == MP_BINARY_OP_REVERSE_TRUE_DIVIDE)) {
+        // In the reflected operators, e.g., 2 - a, the ndarray is passed in lhs, 
+        // so the operands are swapped, and the normal operator is run on them
+        ndarray_obj_t *tmp = ol;
+        ol = or;
+        or = tmp;
+        op = op - MP_BINARY_OP_REVERSE_OR + MP_BINARY_OP_OR;
+    }
+    uint8_t ndim;
+    size_t shape[ULAB_MAX_DIMS];
+    switch(op) {
+        case MP_BINARY_OP_INPLACE_ADD:
+        case MP_BINARY_OP_INPLACE_SUBTRACT:
+        case MP_BINARY_OP_INPLACE_MULTIPLY:
+        case MP_BINARY_OP_INPLACE_TRUE_DIVIDE:
+            return ndarray_inplace_op(op, ol, or);
+        case MP_BINARY_OP_LESS:
+        case MP_BINARY_OP_LESS_EQUAL:
+        case MP_BINARY_OP_MORE:
+        case MP_BINARY_OP_MORE_EQUAL:
+        case MP_BINARY_OP_EQUAL:
+        case MP_BINARY_OP_NOT_EQUAL:
+        case MP_BINARY_OP_ADD:
+        case MP_BINARY_OP_SUBTRACT:
+        case MP_BINARY_OP_TRUE_DIVIDE:
+        case MP_BINARY_OP_MULTIPLY:
+            // the result has the shape of the two operands broadcast against each other
+            ndarray_broadcast_shape(ol, or, &ndim, shape);
+            if((ol->array->typecode == NDARRAY_COMPLEX) || (or->array->typecode == NDARRAY_COMPLEX)) {
+                return ndarray_binary_op_complex(op, ol, or, ndim, shape, target);
+            }
+            if((ol->array->typecode == NDARRAY_FLOAT16) || (or->array->typecode == NDARRAY_FLOAT16)) {
+                return ndarray_binary_op_float16(op, ol, or, ndim, shape, target);
+            }
+            // TODO: I believe, this part can be made significantly smaller (compiled size)
+            // by doing only the typecasting in the large ifs, and moving the loops outside
+            // These are the upcasting rules
+            // float always becomes float
+            // operation on identical types preserves type
+            // uint8 + int8 => int16
+            // uint8 + int16 => int16
+            // uint8 + uint16 => uint16
+            // int8 + int16 => int16
+            // int8 + uint16 => uint16
+            // uint16 + int16 => int32
+            // uint8, uint16 + uint32 => uint32
+            // uint8, int8, uint16, int16 + int32 => int32
+            // int8, int16, int32 + uint32 => float
+            // uint8, int8, uint16, int16, float32 + float32 => float32
+            // uint32, int32 + float32 => float
+            // uint8, int8, float16 + float16 => float16
+            // uint16, int16, float32 + float16 => float32
+            // anything + complex => complex
+            // The parameters of RUN_BINARY_LOOP are 
+            // typecode of result, type_out, type_left, type_right, lhs operand, rhs operand, operator
+            if(ol->array->typecode == NDARRAY_UINT8) {
+                if(or->array->typecode == NDARRAY_UINT8) {
+                    RUN_BINARY_LOOP(NDARRAY_UINT8, uint8_t, uint8_t, uint8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT8) {
+                    RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, uint8_t, int8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT16) {
+                    RUN_BINARY_LOOP(NDARRAY_UINT16, uint16_t, uint8_t, uint16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT16) {
+                    RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, uint8_t, int16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT32) {
+                    RUN_BINARY_LOOP(NDARRAY_UINT32, uint32_t, uint8_t, uint32_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT32) {
+                    RUN_BINARY_LOOP(NDARRAY_INT32, int32_t, uint8_t, int32_t, ol, or, ndim, shape, op, target);
+                } else if(NDARRAY_IS_FLOAT32(or->array->typecode)) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT32, float, uint8_t, float, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_FLOAT) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, uint8_t, mp_float_t, ol, or, ndim, shape, op, target);
+                }
+            } else if(ol->array->typecode == NDARRAY_INT8) {
+                if(or->array->typecode == NDARRAY_UINT8) {
+                    RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, int8_t, uint8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT8) {
+                    RUN_BINARY_LOOP(NDARRAY_INT8, int8_t, int8_t, int8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT16) {
+                    RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, int8_t, uint16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT16) {
+                    RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, int8_t, int16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT32) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, int8_t, uint32_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT32) {
+                    RUN_BINARY_LOOP(NDARRAY_INT32, int32_t, int8_t, int32_t, ol, or, ndim, shape, op, target);
+                } else if(NDARRAY_IS_FLOAT32(or->array->typecode)) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT32, float, int8_t, float, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_FLOAT) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, int8_t, mp_float_t, ol, or, ndim, shape, op, target);
+                }
+            } else if(ol->array->typecode == NDARRAY_UINT16) {
+                if(or->array->typecode == NDARRAY_UINT8) {
+                    RUN_BINARY_LOOP(NDARRAY_UINT16, uint16_t, uint16_t, uint8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT8) {
+                    RUN_BINARY_LOOP(NDARRAY_UINT16, uint16_t, uint16_t, int8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT16) {
+                    RUN_BINARY_LOOP(NDARRAY_UINT16, uint16_t, uint16_t, uint16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT16) {
+                    RUN_BINARY_LOOP(NDARRAY_INT32, int32_t, uint16_t, int16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT32) {
+                    RUN_BINARY_LOOP(NDARRAY_UINT32, uint32_t, uint16_t, uint32_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT32) {
+                    RUN_BINARY_LOOP(NDARRAY_INT32, int32_t, uint16_t, int32_t, ol, or, ndim, shape, op, target);
+                } else if(NDARRAY_IS_FLOAT32(or->array->typecode)) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT32, float, uint16_t, float, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_FLOAT) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, uint16_t, mp_float_t, ol, or, ndim, shape, op, target);
+                }
+            } else if(ol->array->typecode == NDARRAY_INT16) {
+                if(or->array->typecode == NDARRAY_UINT8) {
+                    RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, int16_t, uint8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT8) {
+                    RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, int16_t, int8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT16) {
+                    RUN_BINARY_LOOP(NDARRAY_INT32, int32_t, int16_t, uint16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT16) {
+                    RUN_BINARY_LOOP(NDARRAY_INT16, int16_t, int16_t, int16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT32) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, int16_t, uint32_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT32) {
+                    RUN_BINARY_LOOP(NDARRAY_INT32, int32_t, int16_t, int32_t, ol, or, ndim, shape, op, target);
+                } else if(NDARRAY_IS_FLOAT32(or->array->typecode)) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT32, float, int16_t, float, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_FLOAT) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, int16_t, mp_float_t, ol, or, ndim, shape, op, target);
+                }
+            } else if(ol->array->typecode == NDARRAY_UINT32) {
+                if(or->array->typecode == NDARRAY_UINT8) {
+                    RUN_BINARY_LOOP(NDARRAY_UINT32, uint32_t, uint32_t, uint8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT8) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, uint32_t, int8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT16) {
+                    RUN_BINARY_LOOP(NDARRAY_UINT32, uint32_t, uint32_t, uint16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT16) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, uint32_t, int16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT32) {
+                    RUN_BINARY_LOOP(NDARRAY_UINT32, uint32_t, uint32_t, uint32_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT32) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, uint32_t, int32_t, ol, or, ndim, shape, op, target);
+                } else if(NDARRAY_IS_FLOAT32(or->array->typecode)) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, uint32_t, float, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_FLOAT) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, uint32_t, mp_float_t, ol, or, ndim, shape, op, target);
+                }
+            } else if(ol->array->typecode == NDARRAY_INT32) {
+                if(or->array->typecode == NDARRAY_UINT8) {
+                    RUN_BINARY_LOOP(NDARRAY_INT32, int32_t, int32_t, uint8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT8) {
+                    RUN_BINARY_LOOP(NDARRAY_INT32, int32_t, int32_t, int8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT16) {
+                    RUN_BINARY_LOOP(NDARRAY_INT32, int32_t, int32_t, uint16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT16) {
+                    RUN_BINARY_LOOP(NDARRAY_INT32, int32_t, int32_t, int16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT32) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, int32_t, uint32_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT32) {
+                    RUN_BINARY_LOOP(NDARRAY_INT32, int32_t, int32_t, int32_t, ol, or, ndim, shape, op, target);
+                } else if(NDARRAY_IS_FLOAT32(or->array->typecode)) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, int32_t, float, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_FLOAT) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, int32_t, mp_float_t, ol, or, ndim, shape, op, target);
+                }
+            } else if(NDARRAY_IS_FLOAT32(ol->array->typecode)) {
+                if(or->array->typecode == NDARRAY_UINT8) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT32, float, float, uint8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT8) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT32, float, float, int8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT16) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT32, float, float, uint16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT16) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT32, float, float, int16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT32) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, float, uint32_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT32) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, float, int32_t, ol, or, ndim, shape, op, target);
+                } else if(NDARRAY_IS_FLOAT32(or->array->typecode)) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT32, float, float, float, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_FLOAT) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, float, mp_float_t, ol, or, ndim, shape, op, target);
+                }
+            } else if(ol->array->typecode == NDARRAY_FLOAT) {
+                if(or->array->typecode == NDARRAY_UINT8) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, mp_float_t, uint8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT8) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, mp_float_t, int8_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT16) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, mp_float_t, uint16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT16) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, mp_float_t, int16_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_UINT32) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, mp_float_t, uint32_t, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_INT32) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, mp_float_t, int32_t, ol, or, ndim, shape, op, target);
+                } else if(NDARRAY_IS_FLOAT32(or->array->typecode)) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, mp_float_t, float, ol, or, ndim, shape, op, target);
+                } else if(or->array->typecode == NDARRAY_FLOAT) {
+                    RUN_BINARY_LOOP(NDARRAY_FLOAT, mp_float_t, mp_float_t, mp_float_t, ol, or, ndim, shape, op, target);
+                }
+            } else { // this should never happen
+                mp_raise_TypeError("wrong input type");
+            }
+            // this instruction should never be reached, but we have to make the compiler happy
+            return MP_OBJ_NULL; 
+        default:
+            return MP_OBJ_NULL; // op not supported                                                        
+    }
+}
+
+mp_obj_t ndarray_binary_op(mp_binary_op_t op, mp_obj_t lhs, mp_obj_t rhs) {
+    if(MP_OBJ_IS_TYPE(rhs, &ulab_lazy_type)) {
+        // arithmetic with a lazy array results in a lazy array, 
+        // while the rest of the operators work on the computed values
+        mp_obj_t result = evaluate_lazy_binary_op(op, lhs, rhs);
+        if(result != MP_OBJ_NULL) {
+            return result;
+        }
+        rhs = evaluate_lazy_run(rhs, mp_const_none);
+    }
+    return ndarray_binary_op_helper(op, lhs, rhs, NULL);
+}
+
+STATIC mp_obj_t ndarray_arithmetic(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args, mp_binary_op_t op) {
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+        { MP_QSTR_out, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    
+    if(!mp_obj_is_type(args[0].u_obj, &ulab_ndarray_type) && !mp_obj_is_type(args[1].u_obj, &ulab_ndarray_type)) {
+        mp_raise_TypeError("one of the operands must be an ndarray");
+    }
+    if(args[2].u_obj == mp_const_none) {
+        return ndarray_binary_op_helper(op, args[0].u_obj, args[1].u_obj, NULL);
+    }
+    if(!mp_obj_is_type(args[2].u_obj, &ulab_ndarray_type)) {
+        mp_raise_TypeError("out must be an ndarray");
+    }
+    ndarray_obj_t *target = MP_OBJ_TO_PTR(args[2].u_obj);
+    // the operands must not be overwritten by the results, before they are read
+    mp_obj_t lhs = args[0].u_obj;
+    mp_obj_t rhs = args[1].u_obj;
+    if(mp_obj_is_type(lhs, &ulab_ndarray_type)) {
+        lhs = MP_OBJ_FROM_PTR(ndarray_detach(MP_OBJ_TO_PTR(lhs), target));
+    }
+    if(mp_obj_is_type(rhs, &ulab_ndarray_type)) {
+        rhs = MP_OBJ_FROM_PTR(ndarray_detach(MP_OBJ_TO_PTR(rhs), target));
+    }
+    return ndarray_binary_op_helper(op, lhs, rhs, target);
+}
+
+mp_obj_t ndarray_add(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return ndarray_arithmetic(n_args, pos_args, kw_args, MP_BINARY_OP_ADD);
+}
+
+mp_obj_t ndarray_subtract(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return ndarray_arithmetic(n_args, pos_args, kw_args, MP_BINARY_OP_SUBTRACT);
+}
+
+mp_obj_t ndarray_multiply(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return ndarray_arithmetic(n_args, pos_args, kw_args, MP_BINARY_OP_MULTIPLY);
+}
+
+mp_obj_t ndarray_divide(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return ndarray_arithmetic(n_args, pos_args, kw_args, MP_BINARY_OP_TRUE_DIVIDE);
+}
+
+mp_obj_t ndarray_equal(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return ndarray_arithmetic(n_args, pos_args, kw_args, MP_BINARY_OP_EQUAL);
+}
+
+mp_obj_t ndarray_not_equal(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return ndarray_arithmetic(n_args, pos_args, kw_args, MP_BINARY_OP_NOT_EQUAL);
+}
+
+// Functions of complex arrays
+
+STATIC ndarray_obj_t *ndarray_complex_part(mp_obj_t oin, uint8_t part) {
+    // returns the real (part = 0), or the imaginary (part = 1) parts of the complex ndarray oin 
+    // in a new float array; the elements are read through the strides, so views work, too
+    ndarray_obj_t *source = MP_OBJ_TO_PTR(oin);
+    ndarray_obj_t *out = ndarray_new_empty(source->ndim, source->shape, NDARRAY_FLOAT);
+    mp_float_t *target = (mp_float_t *)out->items;
+    int32_t strides[ULAB_MAX_DIMS];
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        strides[i] = 2 * source->strides[i];
+    }
+    NDARRAY_LOOP(source->shape, mp_float_t, a, (mp_float_t *)source->items + part, strides, *target++ = *a);
+    return out;
+}
+
+STATIC ndarray_obj_t *ndarray_complex_argument(mp_obj_t oin) {
+    if(!mp_obj_is_type(oin, &ulab_ndarray_type)) {
+        mp_raise_TypeError("input must be an ndarray");
+    }
+    return MP_OBJ_TO_PTR(oin);
+}
+
+mp_obj_t ndarray_real(mp_obj_t oin) {
+    // the real part of a real array is the array itself, and it keeps its type
+    ndarray_obj_t *ndarray = ndarray_complex_argument(oin);
+    if(ndarray->array->typecode != NDARRAY_COMPLEX) {
+        return ndarray_copy(oin);
+    }
+    return MP_OBJ_FROM_PTR(ndarray_complex_part(oin, 0));
+}
+
+mp_obj_t ndarray_imag(mp_obj_t oin) {
+    // the imaginary part of a real array consists of 0s of the same type
+    ndarray_obj_t *ndarray = ndarray_complex_argument(oin);
+    if(ndarray->array->typecode != NDARRAY_COMPLEX) {
+        ndarray_obj_t *out = ndarray_new_ndarray(ndarray->ndim, ndarray->shape, ndarray->array->typecode);
+        out->boolean = ndarray->boolean;
+        return MP_OBJ_FROM_PTR(out);
+    }
+    return MP_OBJ_FROM_PTR(ndarray_complex_part(oin, 1));
+}
+
+mp_obj_t ndarray_conjugate(mp_obj_t oin) {
+    ndarray_complex_argument(oin);
+    ndarray_obj_t *out = MP_OBJ_TO_PTR(ndarray_copy(oin));
+    if(out->array->typecode == NDARRAY_COMPLEX) {
+        mp_float_t *array = (mp_float_t *)out->items;
+        for(size_t i=0; i < out->len; i++) {
+            array[2*i+1] = -array[2*i+1];
+        }
+    }
+    return MP_OBJ_FROM_PTR(out);
+}
+
+mp_obj_t ndarray_angle(mp_obj_t oin) {
+    // the argument of the elements in radians; the result is always float
+    ndarray_obj_t *ndarray = ndarray_contiguous(ndarray_complex_argument(oin));
+    ndarray_obj_t *out = ndarray_new_empty(ndarray->ndim, ndarray->shape, NDARRAY_FLOAT);
+    mp_float_t *array = (mp_float_t *)out->items;
+    mp_float_t real, imag;
+    for(size_t i=0; i < ndarray->len; i++) {
+        ndarray_get_complex_value(ndarray->items, ndarray->array->typecode, i, &real, &imag);
+        array[i] = MICROPY_FLOAT_C_FUN(atan2)(imag, real);
+    }
+    return MP_OBJ_FROM_PTR(out);
 }
 
 mp_obj_t ndarray_unary_op(mp_unary_op_t op, mp_obj_t self_in) {
@@ -840,42 +2898,67 @@ mp_obj_t ndarray_unary_op(mp_unary_op_t op, mp_obj_t self_in) {
     ndarray_obj_t *ndarray = NULL;
     switch (op) {
         case MP_UNARY_OP_LEN: 
-            if(self->m > 1) {
-                return mp_obj_new_int(self->m);
+            if(self->ndim > 2) {
+                return mp_obj_new_int(self->shape[ULAB_MAX_DIMS-self->ndim]);
+            } else if(ROWS(self) > 1) {
+                return mp_obj_new_int(ROWS(self));
             } else {
-                return mp_obj_new_int(self->n);
+                return mp_obj_new_int(COLUMNS(self));
             }
             break;
         
         case MP_UNARY_OP_INVERT:
-            if(self->array->typecode == NDARRAY_FLOAT) {
+            if(NDARRAY_IS_FLOAT(self->array->typecode) || (self->array->typecode == NDARRAY_COMPLEX)) {
                 mp_raise_ValueError("operation is not supported for given type");
             }
+            if(self->boolean) { // the inverse of a Boolean is its negation
+                ndarray = MP_OBJ_TO_PTR(ndarray_copy(self_in));
+                uint8_t *array = (uint8_t *)ndarray->items;
+                for(size_t i=0; i < self->len; i++) array[i] ^= 1;
+                return MP_OBJ_FROM_PTR(ndarray);
+            }
             // we can invert the content byte by byte, there is no need to distinguish 
             // between different typecodes
             ndarray = MP_OBJ_TO_PTR(ndarray_copy(self_in));
-            uint8_t *array = (uint8_t *)ndarray->array->items;
+            uint8_t *array = (uint8_t *)ndarray->items;
             for(size_t i=0; i < self->bytes; i++) array[i] = ~array[i];
             return MP_OBJ_FROM_PTR(ndarray);
             break;
         
         case MP_UNARY_OP_NEGATIVE:
+            if(self->boolean) {
+                mp_raise_ValueError("operation is not supported for given type");
+            }
             ndarray = MP_OBJ_TO_PTR(ndarray_copy(self_in));
             if(self->array->typecode == NDARRAY_UINT8) {
-                uint8_t *array = (uint8_t *)ndarray->array->items;
-                for(size_t i=0; i < self->array->len; i++) array[i] = -array[i];
+                uint8_t *array = (uint8_t *)ndarray->items;
+                for(size_t i=0; i < self->len; i++) array[i] = -array[i];
             } else if(self->array->typecode == NDARRAY_INT8) {
-                int8_t *array = (int8_t *)ndarray->array->items;
-                for(size_t i=0; i < self->array->len; i++) array[i] = -array[i];
+                int8_t *array = (int8_t *)ndarray->items;
+                for(size_t i=0; i < self->len; i++) array[i] = -array[i];
             } else if(self->array->typecode == NDARRAY_UINT16) {                
-                uint16_t *array = (uint16_t *)ndarray->array->items;
-                for(size_t i=0; i < self->array->len; i++) array[i] = -array[i];
+                uint16_t *array = (uint16_t *)ndarray->items;
+                for(size_t i=0; i < self->len; i++) array[i] = -array[i];
             } else if(self->array->typecode == NDARRAY_INT16) {
-                int16_t *array = (int16_t *)ndarray->array->items;
-                for(size_t i=0; i < self->array->len; i++) array[i] = -array[i];
+                int16_t *array = (int16_t *)ndarray->items;
+                for(size_t i=0; i < self->len; i++) array[i] = -array[i];
+            } else if(self->array->typecode == NDARRAY_UINT32) {
+                uint32_t *array = (uint32_t *)ndarray->items;
+                for(size_t i=0; i < self->len; i++) array[i] = -array[i];
+            } else if(self->array->typecode == NDARRAY_INT32) {
+                int32_t *array = (int32_t *)ndarray->items;
+                for(size_t i=0; i < self->len; i++) array[i] = -array[i];
+            } else if(NDARRAY_IS_FLOAT32(self->array->typecode)) {
+                float *array = (float *)ndarray->items;
+                for(size_t i=0; i < self->len; i++) array[i] = -array[i];
+            } else if(self->array->typecode == NDARRAY_FLOAT16) {
+                // the sign of a half-precision float is its highest bit
+                uint16_t *array = (uint16_t *)ndarray->items;
+                for(size_t i=0; i < self->len; i++) array[i] ^= 0x8000;
             } else {
-                mp_float_t *array = (mp_float_t *)ndarray->array->items;
-                for(size_t i=0; i < self->array->len; i++) array[i] = -array[i];
+                // complex numbers are negated part by part
+                mp_float_t *array = (mp_float_t *)ndarray->items;
+                for(size_t i=0; i < ndarray->bytes / sizeof(mp_float_t); i++) array[i] = -array[i];
             }
             return MP_OBJ_FROM_PTR(ndarray);
             break;
@@ -884,23 +2967,47 @@ mp_obj_t ndarray_unary_op(mp_unary_op_t op, mp_obj_t self_in) {
             return ndarray_copy(self_in);
 
         case MP_UNARY_OP_ABS:
-            if((self->array->typecode == NDARRAY_UINT8) || (self->array->typecode == NDARRAY_UINT16)) {
+            if(self->array->typecode == NDARRAY_COMPLEX) {
+                // the absolute value of a complex number is its magnitude, a float
+                ndarray_obj_t *in = ndarray_contiguous(self);
+                ndarray = ndarray_new_empty(self->ndim, self->shape, NDARRAY_FLOAT);
+                mp_float_t *source = (mp_float_t *)in->items, *array = (mp_float_t *)ndarray->items;
+                for(size_t i=0; i < self->len; i++, source += 2) {
+                    array[i] = MICROPY_FLOAT_C_FUN(sqrt)(source[0]*source[0] + source[1]*source[1]);
+                }
+                return MP_OBJ_FROM_PTR(ndarray);
+            }
+            if((self->array->typecode == NDARRAY_UINT8) || (self->array->typecode == NDARRAY_UINT16) || 
+               (self->array->typecode == NDARRAY_UINT32)) {
                 return ndarray_copy(self_in);
             }
             ndarray = MP_OBJ_TO_PTR(ndarray_copy(self_in));
             if(self->array->typecode == NDARRAY_INT8) {
-                int8_t *array = (int8_t *)ndarray->array->items;
-                for(size_t i=0; i < self->array->len; i++) {
+                int8_t *array = (int8_t *)ndarray->items;
+                for(size_t i=0; i < self->len; i++) {
                     if(array[i] < 0) array[i] = -array[i];
                 }
             } else if(self->array->typecode == NDARRAY_INT16) {
-                int16_t *array = (int16_t *)ndarray->array->items;
-                for(size_t i=0; i < self->array->len; i++) {
+                int16_t *array = (int16_t *)ndarray->items;
+                for(size_t i=0; i < self->len; i++) {
+                    if(array[i] < 0) array[i] = -array[i];
+                }
+            } else if(self->array->typecode == NDARRAY_INT32) {
+                int32_t *array = (int32_t *)ndarray->items;
+                for(size_t i=0; i < self->len; i++) {
+                    if(array[i] < 0) array[i] = -array[i];
+                }
+            } else if(NDARRAY_IS_FLOAT32(self->array->typecode)) {
+                float *array = (float *)ndarray->items;
+                for(size_t i=0; i < self->len; i++) {
                     if(array[i] < 0) array[i] = -array[i];
                 }
+            } else if(self->array->typecode == NDARRAY_FLOAT16) {
+                uint16_t *array = (uint16_t *)ndarray->items;
+                for(size_t i=0; i < self->len; i++) array[i] &= 0x7fff;
             } else {
-                mp_float_t *array = (mp_float_t *)ndarray->array->items;
-                for(size_t i=0; i < self->array->len; i++) {
+                mp_float_t *array = (mp_float_t *)ndarray->items;
+                for(size_t i=0; i < self->len; i++) {
                     if(array[i] < 0) array[i] = -array[i];
                 }                
             }
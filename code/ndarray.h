@@ -18,12 +18,44 @@
 
 #define PRINT_MAX  10
 
+// The maximum number of dimensions. The loop macros below are written for exactly four axes.
+#define ULAB_MAX_DIMS 4
+
 #if MICROPY_FLOAT_IMPL == MICROPY_FLOAT_IMPL_FLOAT
 #define FLOAT_TYPECODE 'f'
 #elif MICROPY_FLOAT_IMPL == MICROPY_FLOAT_IMPL_DOUBLE
 #define FLOAT_TYPECODE 'd'
 #endif
 
+// On double-precision platforms, single-precision floats are available as a separate storage type. 
+// On single-precision platforms, float32 is the native float, and NDARRAY_FLOAT32 is the same as NDARRAY_FLOAT
+#if MICROPY_FLOAT_IMPL == MICROPY_FLOAT_IMPL_DOUBLE
+#define ULAB_HAS_FLOAT32 (1)
+#else
+#define ULAB_HAS_FLOAT32 (0)
+#endif
+
+// float32 elements are passed to the single-precision functions of libm (sinf, expf, etc.) only, 
+// if ULAB_FLOAT32_LIBM is set, because ports that link the double-precision libm alone don't 
+// provide them; otherwise, the double-precision functions are called, and their results rounded
+#ifndef ULAB_FLOAT32_LIBM
+#define ULAB_FLOAT32_LIBM (0)
+#endif
+
+#if ULAB_FLOAT32_LIBM
+#define ULAB_FLOAT32_C_FUN(fun) fun ## f
+#else
+#define ULAB_FLOAT32_C_FUN(fun) MICROPY_FLOAT_C_FUN(fun)
+#endif
+
+// Complex arrays can be created only, if micropython itself supports complex numbers, 
+// because their elements are returned as complex objects
+#if MICROPY_PY_BUILTINS_COMPLEX
+#define ULAB_HAS_COMPLEX (1)
+#else
+#define ULAB_HAS_COMPLEX (0)
+#endif
+
 const mp_obj_type_t ulab_ndarray_type;
 
 enum NDARRAY_TYPE {
@@ -31,94 +63,350 @@ enum NDARRAY_TYPE {
     NDARRAY_INT8 = 'b',
     NDARRAY_UINT16 = 'H', 
     NDARRAY_INT16 = 'h',
+    NDARRAY_UINT32 = 'I',
+    NDARRAY_INT32 = 'i',
     NDARRAY_FLOAT = FLOAT_TYPECODE,
+    NDARRAY_FLOAT32 = 'f',
+    // half-precision floats are stored as their IEEE 754 bits in uint16s, and are converted 
+    // to mp_float_t, when they are read; micropython itself doesn't know this typecode
+    NDARRAY_FLOAT16 = 'e',
+    // complex numbers are stored as interleaved pairs of mp_float_t, the real part first; 
+    // this typecode is also unknown to micropython
+    NDARRAY_COMPLEX = 'c',
 };
 
+// The test for the float32 storage type is false at compile time on single-precision platforms, 
+// so that the float32 branches are compiled only, where they are distinct from NDARRAY_FLOAT
+#define NDARRAY_IS_FLOAT32(typecode) (ULAB_HAS_FLOAT32 && ((typecode) == NDARRAY_FLOAT32))
+#define NDARRAY_IS_FLOAT(typecode) (((typecode) == NDARRAY_FLOAT) || NDARRAY_IS_FLOAT32(typecode) || ((typecode) == NDARRAY_FLOAT16))
+
+// A single complex element; the elements of complex arrays are copied verbatim through this type, 
+// when they are larger than 8 bytes
+typedef struct _ndarray_complex_t {
+    mp_float_t real;
+    mp_float_t imag;
+} ndarray_complex_t;
+
+// Boolean arrays are stored as uint8 0s, and 1s, and are marked by the boolean member of the ndarray; 
+// this typecode is used only in the dtype keyword arguments
+#define NDARRAY_BOOL '?'
+
 typedef struct _ndarray_obj_t {
     mp_obj_base_t base;
-    size_t m, n;
+    // shape, and strides are aligned to the right: the last axis is always at ULAB_MAX_DIMS-1, 
+    // and the unused leading axes have length 1. An ndarray has at least two dimensions, 
+    // linear arrays are row vectors of shape (1, n)
+    uint8_t ndim;
+    // the elements of a Boolean array are uint8 0s, and 1s, which are returned as False, and True
+    uint8_t boolean;
+    size_t shape[ULAB_MAX_DIMS];
     size_t len;
+    // array holds the storage, and it is shared between an ndarray and all views taken from it; 
+    // this reference also keeps the storage alive, as long as there is a view pointing into it
     mp_obj_array_t *array;
     size_t bytes;
+    // items points to the first element of the ndarray in array->items, and the strides 
+    // are the distances between consecutive elements along each axis in units of the element size
+    void *items;
+    int32_t strides[ULAB_MAX_DIMS];
 } ndarray_obj_t;
 
+// the last two axes are the rows, and the columns of a matrix
+#define ROWS(ndarray) ((ndarray)->shape[ULAB_MAX_DIMS-2])
+#define COLUMNS(ndarray) ((ndarray)->shape[ULAB_MAX_DIMS-1])
+
 mp_obj_t mp_obj_new_ndarray_iterator(mp_obj_t , size_t , mp_obj_iter_buf_t *);
 
+size_t ndarray_itemsize(uint8_t );
+mp_float_t ndarray_float16_to_float(uint16_t );
+uint16_t ndarray_float_to_float16(mp_float_t );
 mp_float_t ndarray_get_float_value(void *, uint8_t , size_t );
+void ndarray_set_float_value(void *, uint8_t , size_t , mp_float_t );
+void ndarray_get_complex_value(void *, uint8_t , size_t , mp_float_t *, mp_float_t *);
+void ndarray_check_real(ndarray_obj_t *);
+mp_obj_t ndarray_get_value(uint8_t , void *, size_t );
+mp_float_t ndarray_round_nearest(mp_float_t );
+int64_t ndarray_float_to_integer(mp_float_t , mp_float_t (*)(mp_float_t), bool , int64_t , int64_t );
+void ndarray_set_value(uint8_t , void *, size_t , mp_obj_t );
+mp_obj_t ndarray_get_item(ndarray_obj_t *, void *);
 void fill_array_iterable(mp_float_t *, mp_obj_t );
 
-void ndarray_print_row(const mp_print_t *, mp_obj_array_t *, size_t , size_t );
+void ndarray_print_row(const mp_print_t *, ndarray_obj_t *, uint8_t *, size_t , int32_t );
 void ndarray_print(const mp_print_t *, mp_obj_t , mp_print_kind_t );
 void ndarray_assign_elements(mp_obj_array_t *, mp_obj_t , uint8_t , size_t *);
+ndarray_obj_t *ndarray_new_empty(uint8_t , size_t *, uint8_t );
+ndarray_obj_t *ndarray_new_ndarray(uint8_t , size_t *, uint8_t );
 ndarray_obj_t *create_new_ndarray(size_t , size_t , uint8_t );
+ndarray_obj_t *create_empty_ndarray(size_t , size_t , uint8_t );
+ndarray_obj_t *ndarray_new_view(ndarray_obj_t *, uint8_t , size_t *, int32_t *, int32_t );
+bool ndarray_is_dense(ndarray_obj_t *);
+ndarray_obj_t *ndarray_contiguous(ndarray_obj_t *);
+void ndarray_copy_elements(ndarray_obj_t *, ndarray_obj_t *);
+ndarray_obj_t *ndarray_detach(ndarray_obj_t *, ndarray_obj_t *);
+ndarray_obj_t *ndarray_check_out(mp_obj_t , size_t *, uint8_t );
+void ndarray_broadcast_shape(ndarray_obj_t *, ndarray_obj_t *, uint8_t *, size_t *);
+ndarray_obj_t *ndarray_binary_output(uint8_t , size_t *, uint8_t , ndarray_obj_t *);
+void ndarray_broadcast_strides(ndarray_obj_t *, int32_t *);
+ndarray_obj_t *ndarray_binary_operand(mp_obj_t , ndarray_obj_t *, mp_obj_array_t *, mp_float_t *);
+uint8_t ndarray_normalise_axis(ndarray_obj_t *, mp_obj_t );
+mp_obj_t ndarray_bool_list(ndarray_obj_t *);
 
 mp_obj_t ndarray_copy(mp_obj_t );
 mp_obj_t ndarray_make_new(const mp_obj_type_t *, size_t , size_t , const mp_obj_t *);
+mp_obj_t ndarray_frombuffer(size_t , const mp_obj_t *, mp_map_t *);
 mp_obj_t ndarray_subscr(mp_obj_t , mp_obj_t , mp_obj_t );
 mp_obj_t ndarray_getiter(mp_obj_t , mp_obj_iter_buf_t *);
 mp_obj_t ndarray_binary_op(mp_binary_op_t , mp_obj_t , mp_obj_t );
 mp_obj_t ndarray_unary_op(mp_unary_op_t , mp_obj_t );
+mp_obj_t ndarray_add(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t ndarray_subtract(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t ndarray_multiply(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t ndarray_divide(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t ndarray_equal(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t ndarray_not_equal(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t ndarray_take(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t ndarray_put(mp_obj_t , mp_obj_t , mp_obj_t );
+mp_obj_t ndarray_take_along_axis(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t ndarray_real(mp_obj_t );
+mp_obj_t ndarray_imag(mp_obj_t );
+mp_obj_t ndarray_conjugate(mp_obj_t );
+mp_obj_t ndarray_angle(mp_obj_t );
 
 mp_obj_t ndarray_shape(mp_obj_t );
 mp_obj_t ndarray_rawsize(mp_obj_t );
 mp_obj_t ndarray_flatten(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t ndarray_astype(size_t , const mp_obj_t *, mp_map_t *);
+ndarray_obj_t *ndarray_convert(ndarray_obj_t *, uint8_t , bool , bool , mp_float_t (*)(mp_float_t ));
 mp_obj_t ndarray_asbytearray(mp_obj_t );
+mp_int_t ndarray_get_buffer(mp_obj_t , mp_buffer_info_t *, mp_uint_t );
 
-#define CREATE_SINGLE_ITEM(outarray, type, typecode, value) do {\
-    ndarray_obj_t *tmp = create_new_ndarray(1, 1, (typecode));\
-    type *tmparr = (type *)tmp->array->items;\
-    tmparr[0] = (type)(value);\
-    (outarray) = MP_OBJ_FROM_PTR(tmp);\
+// Loops over all elements of an array of the given shape in C order. The pointer a starts at 
+// start_a, and is advanced by strides_a (in units of type_a) along each axis; the loop body 
+// can refer to the current element as *a
+#define NDARRAY_LOOP(shape, type_a, a, start_a, strides_a, body) do {\
+    type_a *_a0 = (type_a *)(start_a);\
+    for(size_t _i0=0; _i0 < (shape)[0]; _i0++, _a0 += (strides_a)[0]) {\
+        type_a *_a1 = _a0;\
+        for(size_t _i1=0; _i1 < (shape)[1]; _i1++, _a1 += (strides_a)[1]) {\
+            type_a *_a2 = _a1;\
+            for(size_t _i2=0; _i2 < (shape)[2]; _i2++, _a2 += (strides_a)[2]) {\
+                type_a *a = _a2;\
+                for(size_t _i3=0; _i3 < (shape)[3]; _i3++, a += (strides_a)[3]) {\
+                    body;\
+                }\
+            }\
+        }\
+    }\
 } while(0)
 
-/*  
-    mp_obj_t row = mp_obj_new_list(n, NULL);
-    mp_obj_list_t *row_ptr = MP_OBJ_TO_PTR(row);
-    
-    should work outside the loop, but it doesn't. Go figure! 
-*/
+// The same as NDARRAY_LOOP, but walks through two arrays in tandem
+#define NDARRAY_LOOP2(shape, type_a, a, start_a, strides_a, type_b, b, start_b, strides_b, body) do {\
+    type_a *_a0 = (type_a *)(start_a);\
+    type_b *_b0 = (type_b *)(start_b);\
+    for(size_t _i0=0; _i0 < (shape)[0]; _i0++, _a0 += (strides_a)[0], _b0 += (strides_b)[0]) {\
+        type_a *_a1 = _a0;\
+        type_b *_b1 = _b0;\
+        for(size_t _i1=0; _i1 < (shape)[1]; _i1++, _a1 += (strides_a)[1], _b1 += (strides_b)[1]) {\
+            type_a *_a2 = _a1;\
+            type_b *_b2 = _b1;\
+            for(size_t _i2=0; _i2 < (shape)[2]; _i2++, _a2 += (strides_a)[2], _b2 += (strides_b)[2]) {\
+                type_a *a = _a2;\
+                type_b *b = _b2;\
+                for(size_t _i3=0; _i3 < (shape)[3]; _i3++, a += (strides_a)[3], b += (strides_b)[3]) {\
+                    body;\
+                }\
+            }\
+        }\
+    }\
+} while(0)
+
+// The same as NDARRAY_LOOP, but walks through three arrays in tandem
+#define NDARRAY_LOOP3(shape, type_a, a, start_a, strides_a, type_b, b, start_b, strides_b, type_c, c, start_c, strides_c, body) do {\
+    type_a *_a0 = (type_a *)(start_a);\
+    type_b *_b0 = (type_b *)(start_b);\
+    type_c *_c0 = (type_c *)(start_c);\
+    for(size_t _i0=0; _i0 < (shape)[0]; _i0++, _a0 += (strides_a)[0], _b0 += (strides_b)[0], _c0 += (strides_c)[0]) {\
+        type_a *_a1 = _a0;\
+        type_b *_b1 = _b0;\
+        type_c *_c1 = _c0;\
+        for(size_t _i1=0; _i1 < (shape)[1]; _i1++, _a1 += (strides_a)[1], _b1 += (strides_b)[1], _c1 += (strides_c)[1]) {\
+            type_a *_a2 = _a1;\
+            type_b *_b2 = _b1;\
+            type_c *_c2 = _c1;\
+            for(size_t _i2=0; _i2 < (shape)[2]; _i2++, _a2 += (strides_a)[2], _b2 += (strides_b)[2], _c2 += (strides_c)[2]) {\
+                type_a *a = _a2;\
+                type_b *b = _b2;\
+                type_c *c = _c2;\
+                for(size_t _i3=0; _i3 < (shape)[3]; _i3++, a += (strides_a)[3], b += (strides_b)[3], c += (strides_c)[3]) {\
+                    body;\
+                }\
+            }\
+        }\
+    }\
+} while(0)
+
+// Walks through the elements of ol, and or in tandem over the given shape; axes of length 1 
+// of either operand are broadcast. The loop body can refer to the current elements as *l, and *r. 
+// If one of the operands has a single element (e.g., it is a scalar), its value is read only once, 
+// before the loop, so that it can be kept in a register, and only the other operand is walked
+#define BINARY_LOOP(ol, or, shape, type_left, type_right, body) do {\
+    if((or)->len == 1) {\
+        type_right _r = *(type_right *)(or)->items, *r = &_r;\
+        NDARRAY_LOOP((shape), type_left, l, (ol)->items, (ol)->strides, body);\
+    } else if((ol)->len == 1) {\
+        type_left _l = *(type_left *)(ol)->items, *l = &_l;\
+        NDARRAY_LOOP((shape), type_right, r, (or)->items, (or)->strides, body);\
+    } else {\
+        int32_t lstrides[ULAB_MAX_DIMS], rstrides[ULAB_MAX_DIMS];\
+        ndarray_broadcast_strides((ol), lstrides);\
+        ndarray_broadcast_strides((or), rstrides);\
+        NDARRAY_LOOP2((shape), type_left, l, (ol)->items, lstrides, type_right, r, (or)->items, rstrides, body);\
+    }\
+} while(0)
+
+// Walks through the operands of a binary operation with the strides lstrides, and rstrides, which are 
+// measured in bytes, so that operands of any type can be combined; the loop body can refer to the 
+// values of the current elements converted to mp_float_t as x, and y. This is used with float16 operands
+#define CONVERTING_BINARY_LOOP(ol, or, lstrides, rstrides, shape, body) do {\
+    NDARRAY_LOOP2((shape), uint8_t, _l, (ol)->items, (lstrides), uint8_t, _r, (or)->items, (rstrides), {\
+        mp_float_t x = ndarray_get_float_value(_l, (ol)->array->typecode, 0);\
+        mp_float_t y = ndarray_get_float_value(_r, (or)->array->typecode, 0);\
+        body;\
+    });\
+} while(0)
+
+// The same as CONVERTING_BINARY_LOOP for operations, in which one of the operands is complex; 
+// the real, and imaginary parts of the current elements are xr, xi, and yr, yi
+#define COMPLEX_BINARY_LOOP(ol, or, lstrides, rstrides, shape, body) do {\
+    NDARRAY_LOOP2((shape), uint8_t, _l, (ol)->items, (lstrides), uint8_t, _r, (or)->items, (rstrides), {\
+        mp_float_t xr;\
+        mp_float_t xi;\
+        mp_float_t yr;\
+        mp_float_t yi;\
+        ndarray_get_complex_value(_l, (ol)->array->typecode, 0, &xr, &xi);\
+        ndarray_get_complex_value(_r, (or)->array->typecode, 0, &yr, &yi);\
+        body;\
+    });\
+} while(0)
 
-#define RUN_BINARY_LOOP(typecode, type_out, type_left, type_right, ol, or, op) do {\
-    type_left *left = (type_left *)(ol)->array->items;\
-    type_right *right = (type_right *)(or)->array->items;\
-    uint8_t inc = 0;\
-    if((or)->array->len > 1) inc = 1;\
+// Copies the elements of ndarray, where the Boolean mask is True, into the dense array out. 
+// The mask is walked with mstrides, so that it can be broadcast along some of the axes
+#define MASK_GATHER(type, ndarray, mask, mstrides, out) do {\
+    type *_o = (type *)(out)->items;\
+    NDARRAY_LOOP2((ndarray)->shape, type, a, (ndarray)->items, (ndarray)->strides, \
+                  uint8_t, m, (mask)->items, (mstrides), if(*m) *_o++ = *a);\
+} while(0)
+
+// The reverse of MASK_GATHER: writes the consecutive elements of the dense array values into 
+// the masked positions of ndarray; vstep is 0, if the single element of values is repeated
+#define MASK_SCATTER(type, ndarray, mask, mstrides, values, vstep) do {\
+    type *_v = (type *)(values)->items;\
+    NDARRAY_LOOP2((ndarray)->shape, type, a, (ndarray)->items, (ndarray)->strides, \
+                  uint8_t, m, (mask)->items, (mstrides), if(*m) { *a = *_v; _v += (vstep); });\
+} while(0)
+
+// Converts the elements of source into the dense array out of type type_out; the loop body 
+// can refer to the current element of source as *a
+#define ASTYPE_LOOP(type_out, type_in, source, out, value) do {\
+    type_out *_o = (type_out *)(out)->items;\
+    NDARRAY_LOOP((source)->shape, type_in, a, (source)->items, (source)->strides, *_o++ = (type_out)(value));\
+} while(0)
+
+// Runs ASTYPE_LOOP with the type of source; the value written is given by int_value, 
+// if source is of integer type, and by float_value otherwise
+#define ASTYPE_DISPATCH(type_out, source, out, int_value, float_value) do {\
+    if((source)->array->typecode == NDARRAY_UINT8) {\
+        ASTYPE_LOOP(type_out, uint8_t, (source), (out), int_value);\
+    } else if((source)->array->typecode == NDARRAY_INT8) {\
+        ASTYPE_LOOP(type_out, int8_t, (source), (out), int_value);\
+    } else if((source)->array->typecode == NDARRAY_UINT16) {\
+        ASTYPE_LOOP(type_out, uint16_t, (source), (out), int_value);\
+    } else if((source)->array->typecode == NDARRAY_INT16) {\
+        ASTYPE_LOOP(type_out, int16_t, (source), (out), int_value);\
+    } else if((source)->array->typecode == NDARRAY_UINT32) {\
+        ASTYPE_LOOP(type_out, uint32_t, (source), (out), int_value);\
+    } else if((source)->array->typecode == NDARRAY_INT32) {\
+        ASTYPE_LOOP(type_out, int32_t, (source), (out), int_value);\
+    } else if(NDARRAY_IS_FLOAT32((source)->array->typecode)) {\
+        ASTYPE_LOOP(type_out, float, (source), (out), float_value);\
+    } else if((source)->array->typecode == NDARRAY_FLOAT16) {\
+        /* half-precision floats are converted first, so that *a is an mp_float_t in float_value */\
+        type_out *_o = (type_out *)(out)->items;\
+        NDARRAY_LOOP((source)->shape, uint16_t, _h, (source)->items, (source)->strides, \
+                     { mp_float_t _f = ndarray_float16_to_float(*_h); mp_float_t *a = &_f; *_o++ = (type_out)(float_value); });\
+    } else {\
+        ASTYPE_LOOP(type_out, mp_float_t, (source), (out), float_value);\
+    }\
+} while(0)
+
+// Fills the dense ndarray with the values of range(start, ..., step); the integers are 
+// converted to type by a plain cast, as in mp_binary_set_val_array
+#define RANGE_LOOP(type, ndarray, start, step, value) do {\
+    type *_o = (type *)(ndarray)->items;\
+    mp_int_t a = (start);\
+    for(size_t _i=0; _i < (ndarray)->len; _i++, a += (step)) {\
+        *_o++ = (value);\
+    }\
+} while(0)
+
+// Compares a, and b with op; both operands are converted to a common type first, so that the 
+// comparison is exact, and there is no mix of signed, and unsigned operands. Integers are compared 
+// as int32s, if both are narrower than 32 bits, and as int64s otherwise, because neither the 
+// upcast of the binary operators (e.g., int8, and uint16 result in uint16), nor a float (whose 
+// mantissa has only 24 bits on single-precision platforms) can hold both operands. Other operands 
+// are compared in type_out. The conditions are evaluated at compile time
+#define NDARRAY_IS_INTEGER_TYPE(type) ((type)1/(type)2 == 0)
+
+#define NDARRAY_COMPARE(type_out, type_left, type_right, a, b, op) \
+    ((NDARRAY_IS_INTEGER_TYPE(type_left) && NDARRAY_IS_INTEGER_TYPE(type_right)) ? \
+        (((sizeof(type_left) < sizeof(int32_t)) && (sizeof(type_right) < sizeof(int32_t))) ? \
+            ((int32_t)(a) op (int32_t)(b)) : ((int64_t)(a) op (int64_t)(b))) : \
+        ((type_out)(a) op (type_out)(b)))
+
+// The result has ndim dimensions, and the given shape; it is written into target, 
+// if it is not NULL, and into a new ndarray otherwise. The arithmetic is carried out in type_out
+#define RUN_BINARY_LOOP(typecode, type_out, type_left, type_right, ol, or, ndim, shape, op, target) do {\
     if(((op) == MP_BINARY_OP_ADD) || ((op) == MP_BINARY_OP_SUBTRACT) || ((op) == MP_BINARY_OP_MULTIPLY)) {\
-        ndarray_obj_t *out = create_new_ndarray(ol->m, ol->n, typecode);\
-        type_out *(odata) = (type_out *)out->array->items;\
-        if((op) == MP_BINARY_OP_ADD) { for(size_t i=0, j=0; i < (ol)->array->len; i++, j+=inc) odata[i] = left[i] + right[j];}\
-        if((op) == MP_BINARY_OP_SUBTRACT) { for(size_t i=0, j=0; i < (ol)->array->len; i++, j+=inc) odata[i] = left[i] - right[j];}\
-        if((op) == MP_BINARY_OP_MULTIPLY) { for(size_t i=0, j=0; i < (ol)->array->len; i++, j+=inc) odata[i] = left[i] * right[j];}\
+        ndarray_obj_t *out = ndarray_binary_output((ndim), (shape), typecode, (target));\
+        type_out *(odata) = (type_out *)out->items;\
+        if((op) == MP_BINARY_OP_ADD) { BINARY_LOOP((ol), (or), (shape), type_left, type_right, *odata++ = (type_out)*l + (type_out)*r);}\
+        if((op) == MP_BINARY_OP_SUBTRACT) { BINARY_LOOP((ol), (or), (shape), type_left, type_right, *odata++ = (type_out)*l - (type_out)*r);}\
+        if((op) == MP_BINARY_OP_MULTIPLY) { BINARY_LOOP((ol), (or), (shape), type_left, type_right, *odata++ = (type_out)*l * (type_out)*r);}\
+        return MP_OBJ_FROM_PTR(out);\
+    } else if(((op) == MP_BINARY_OP_TRUE_DIVIDE) && NDARRAY_IS_FLOAT32(typecode)) {\
+        /* the quotient of integers is a float, but float32 operands keep their precision */\
+        ndarray_obj_t *out = ndarray_binary_output((ndim), (shape), NDARRAY_FLOAT32, (target));\
+        float *odata = (float *)out->items;\
+        BINARY_LOOP((ol), (or), (shape), type_left, type_right, *odata++ = (float)*l/(float)*r);\
         return MP_OBJ_FROM_PTR(out);\
     } else if((op) == MP_BINARY_OP_TRUE_DIVIDE) {\
-        ndarray_obj_t *out = create_new_ndarray(ol->m, ol->n, NDARRAY_FLOAT);\
-        mp_float_t *odata = (mp_float_t *)out->array->items;\
-        for(size_t i=0, j=0; i < (ol)->array->len; i++, j+=inc) odata[i] = (mp_float_t)left[i]/(mp_float_t)right[j];\
+        ndarray_obj_t *out = ndarray_binary_output((ndim), (shape), NDARRAY_FLOAT, (target));\
+        mp_float_t *odata = (mp_float_t *)out->items;\
+        BINARY_LOOP((ol), (or), (shape), type_left, type_right, *odata++ = (mp_float_t)*l/(mp_float_t)*r);\
         return MP_OBJ_FROM_PTR(out);\
     } else if(((op) == MP_BINARY_OP_LESS) || ((op) == MP_BINARY_OP_LESS_EQUAL) ||  \
-             ((op) == MP_BINARY_OP_MORE) || ((op) == MP_BINARY_OP_MORE_EQUAL)) {\
-        mp_obj_t out_list = mp_obj_new_list(0, NULL);\
-        size_t m = (ol)->m, n = (ol)->n;\
-        for(size_t i=0, r=0; i < m; i++, r+=inc) {\
-            mp_obj_t row = mp_obj_new_list(n, NULL);\
-            mp_obj_list_t *row_ptr = MP_OBJ_TO_PTR(row);\
-            for(size_t j=0, s=0; j < n; j++, s+=inc) {\
-                row_ptr->items[j] = mp_const_false;\
-                if((op) == MP_BINARY_OP_LESS) {\
-                    if(left[i*n+j] < right[r*n+s]) row_ptr->items[j] = mp_const_true;\
-                } else if((op) == MP_BINARY_OP_LESS_EQUAL) {\
-                    if(left[i*n+j] <= right[r*n+s]) row_ptr->items[j] = mp_const_true;\
-                } else if((op) == MP_BINARY_OP_MORE) {\
-                    if(left[i*n+j] > right[r*n+s]) row_ptr->items[j] = mp_const_true;\
-                } else if((op) == MP_BINARY_OP_MORE_EQUAL) {\
-                    if(left[i*n+j] >= right[r*n+s]) row_ptr->items[j] = mp_const_true;\
-                }\
-            }\
-            if(m == 1) return row;\
-            mp_obj_list_append(out_list, row);\
-        }\
-        return out_list;\
+             ((op) == MP_BINARY_OP_MORE) || ((op) == MP_BINARY_OP_MORE_EQUAL) || \
+             ((op) == MP_BINARY_OP_EQUAL) || ((op) == MP_BINARY_OP_NOT_EQUAL)) {\
+        /* comparisons result in a Boolean array, unless the results go into target */\
+        ndarray_obj_t *out = ndarray_binary_output((ndim), (shape), NDARRAY_BOOL, (target));\
+        uint8_t *odata = (uint8_t *)out->items;\
+        if((op) == MP_BINARY_OP_LESS) { BINARY_LOOP((ol), (or), (shape), type_left, type_right, *odata++ = NDARRAY_COMPARE(type_out, type_left, type_right, *l, *r, <));}\
+        if((op) == MP_BINARY_OP_LESS_EQUAL) { BINARY_LOOP((ol), (or), (shape), type_left, type_right, *odata++ = NDARRAY_COMPARE(type_out, type_left, type_right, *l, *r, <=));}\
+        if((op) == MP_BINARY_OP_MORE) { BINARY_LOOP((ol), (or), (shape), type_left, type_right, *odata++ = NDARRAY_COMPARE(type_out, type_left, type_right, *l, *r, >));}\
+        if((op) == MP_BINARY_OP_MORE_EQUAL) { BINARY_LOOP((ol), (or), (shape), type_left, type_right, *odata++ = NDARRAY_COMPARE(type_out, type_left, type_right, *l, *r, >=));}\
+        if((op) == MP_BINARY_OP_EQUAL) { BINARY_LOOP((ol), (or), (shape), type_left, type_right, *odata++ = NDARRAY_COMPARE(type_out, type_left, type_right, *l, *r, ==));}\
+        if((op) == MP_BINARY_OP_NOT_EQUAL) { BINARY_LOOP((ol), (or), (shape), type_left, type_right, *odata++ = NDARRAY_COMPARE(type_out, type_left, type_right, *l, *r, !=));}\
+        return MP_OBJ_FROM_PTR(out);\
     }\
 } while(0)
 
+// The in-place version of RUN_BINARY_LOOP: the result is written into ol, and ol is returned
+#define RUN_INPLACE_LOOP(type_left, type_right, ol, or, op) do {\
+    if((op) == MP_BINARY_OP_INPLACE_ADD) { BINARY_LOOP((ol), (or), (ol)->shape, type_left, type_right, *l += *r);}\
+    if((op) == MP_BINARY_OP_INPLACE_SUBTRACT) { BINARY_LOOP((ol), (or), (ol)->shape, type_left, type_right, *l -= *r);}\
+    if((op) == MP_BINARY_OP_INPLACE_MULTIPLY) { BINARY_LOOP((ol), (or), (ol)->shape, type_left, type_right, *l *= *r);}\
+    if((op) == MP_BINARY_OP_INPLACE_TRUE_DIVIDE) { BINARY_LOOP((ol), (or), (ol)->shape, type_left, type_right, *l /= *r);}\
+    return MP_OBJ_FROM_PTR(ol);\
+} while(0)
+
 #endif
@@ -16,17 +16,9 @@
 #include "py/runtime.h"
 #include "py/builtin.h"
 #include "py/misc.h"
+#include "linalg.h"
 #include "numerical.h"
-
-enum NUMERICAL_FUNCTION_TYPE {
-    NUMERICAL_MIN,
-    NUMERICAL_MAX,
-    NUMERICAL_ARGMIN,
-    NUMERICAL_ARGMAX,
-    NUMERICAL_SUM,
-    NUMERICAL_MEAN,
-    NUMERICAL_STD,
-};
+#include "evaluate.h"
 
 mp_obj_t numerical_linspace(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     static const mp_arg_t allowed_args[] = {
@@ -52,19 +44,30 @@ mp_obj_t numerical_linspace(size_t n_args, const mp_obj_t *pos_args, mp_map_t *k
     else step = (mp_obj_get_float(args[1].u_obj)-value)/len;
     ndarray_obj_t *ndarray = create_new_ndarray(1, len, typecode);
     if(typecode == NDARRAY_UINT8) {
-        uint8_t *array = (uint8_t *)ndarray->array->items;
+        uint8_t *array = (uint8_t *)ndarray->items;
         for(size_t i=0; i < len; i++, value += step) array[i] = (uint8_t)value;
     } else if(typecode == NDARRAY_INT8) {
-        int8_t *array = (int8_t *)ndarray->array->items;
+        int8_t *array = (int8_t *)ndarray->items;
         for(size_t i=0; i < len; i++, value += step) array[i] = (int8_t)value;
     } else if(typecode == NDARRAY_UINT16) {
-        uint16_t *array = (uint16_t *)ndarray->array->items;
+        uint16_t *array = (uint16_t *)ndarray->items;
         for(size_t i=0; i < len; i++, value += step) array[i] = (uint16_t)value;
     } else if(typecode == NDARRAY_INT16) {
-        int16_t *array = (int16_t *)ndarray->array->items;
+        int16_t *array = (int16_t *)ndarray->items;
         for(size_t i=0; i < len; i++, value += step) array[i] = (int16_t)value;
+    } else if(typecode == NDARRAY_UINT32) {
+        uint32_t *array = (uint32_t *)ndarray->items;
+        for(size_t i=0; i < len; i++, value += step) array[i] = (uint32_t)value;
+    } else if(typecode == NDARRAY_INT32) {
+        int32_t *array = (int32_t *)ndarray->items;
+        for(size_t i=0; i < len; i++, value += step) array[i] = (int32_t)value;
+    } else if(typecode == NDARRAY_FLOAT16) {
+        for(size_t i=0; i < len; i++, value += step) ndarray_set_float_value(ndarray->items, typecode, i, value);
+    } else if(NDARRAY_IS_FLOAT32(typecode)) {
+        float *array = (float *)ndarray->items;
+        for(size_t i=0; i < len; i++, value += step) array[i] = (float)value;
     } else {
-        mp_float_t *array = (mp_float_t *)ndarray->array->items;
+        mp_float_t *array = (mp_float_t *)ndarray->items;
         for(size_t i=0; i < len; i++, value += step) array[i] = value;
     }
     if(args[4].u_obj == mp_const_false) {
@@ -124,36 +127,62 @@ STATIC mp_float_t numerical_sum_mean_std_single_line(void *data, size_t start, s
     }
 }
 
+STATIC bool numerical_is_flat(ndarray_obj_t *in, mp_obj_t axis) {
+    // returns true, if the reduction is to be carried out on the flattened array
+    return (axis == mp_const_none) || ((in->ndim == 2) && ((ROWS(in) == 1) || (COLUMNS(in) == 1)));
+}
+
+STATIC ndarray_obj_t *numerical_reduce_axis(ndarray_obj_t *in, uint8_t ax, uint8_t typecode, size_t *outer, size_t *inner) {
+    // creates the output of a reduction along the axis ax of the dense array in. 
+    // The lines along ax start at o*in->shape[ax]*inner + i for o < outer, i < inner, 
+    // and the elements of a line are inner apart; the result of the line is at o*inner + i.
+    // Matrices keep their two dimensions, while otherwise the axis is removed
+    size_t shape[ULAB_MAX_DIMS];
+    *outer = 1;
+    *inner = 1;
+    for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+        shape[i] = 1;
+        if(i < ax) {
+            *outer *= in->shape[i];
+        } else if(i > ax) {
+            *inner *= in->shape[i];
+        }
+    }
+    if(in->ndim == 2) {
+        shape[ULAB_MAX_DIMS-2] = (ax == ULAB_MAX_DIMS-2) ? 1 : ROWS(in);
+        shape[ULAB_MAX_DIMS-1] = (ax == ULAB_MAX_DIMS-2) ? COLUMNS(in) : 1;
+        return ndarray_new_ndarray(2, shape, typecode);
+    }
+    for(uint8_t i=ax; i > 0; i--) {
+        shape[i] = in->shape[i-1];
+    }
+    for(uint8_t i=ax+1; i < ULAB_MAX_DIMS; i++) {
+        shape[i] = in->shape[i];
+    }
+    return ndarray_new_ndarray(in->ndim-1, shape, typecode);
+}
+
 STATIC mp_obj_t numerical_sum_mean_std_matrix(mp_obj_t oin, mp_obj_t axis, uint8_t optype) {
-    ndarray_obj_t *in = MP_OBJ_TO_PTR(oin);
-    if((axis == mp_const_none) || (in->m == 1) || (in->n == 1)) { 
+    ndarray_obj_t *in = ndarray_contiguous(MP_OBJ_TO_PTR(oin));
+    if(numerical_is_flat(in, axis)) { 
         // return the value for the flattened array
-        return mp_obj_new_float(numerical_sum_mean_std_single_line(in->array->items, 0, 
-                                                      in->array->len, 1, in->array->typecode, optype));
+        return mp_obj_new_float(numerical_sum_mean_std_single_line(in->items, 0, 
+                                                      in->len, 1, in->array->typecode, optype));
     } else {
-        uint8_t _axis = mp_obj_get_int(axis);
-        size_t m = (_axis == 0) ? 1 : in->m;
-        size_t n = (_axis == 0) ? in->n : 1;
-        size_t len = in->array->len;
-        mp_float_t sms;
-        // TODO: pass in->array->typcode to create_new_ndarray
-        ndarray_obj_t *out = create_new_ndarray(m, n, NDARRAY_FLOAT);
-
-        // TODO: these two cases could probably be combined in a more elegant fashion...
-        if(_axis == 0) { // vertical
-            for(size_t i=0; i < n; i++) {
-                sms = numerical_sum_mean_std_single_line(in->array->items, i, len, 
-                                                               n, in->array->typecode, optype);
-                ((float_t *)out->array->items)[i] = sms;
-            }
-        } else { // horizontal
-            for(size_t i=0; i < m; i++) {
-                sms = numerical_sum_mean_std_single_line(in->array->items, i*in->n, 
-                                                               (i+1)*in->n, 1, in->array->typecode, optype);
-                ((float_t *)out->array->items)[i] = sms;
+        uint8_t ax = ndarray_normalise_axis(in, axis);
+        size_t outer, inner, len = in->shape[ax];
+        // float32, and float16 arrays keep their type, everything else results in float
+        uint8_t typecode = NDARRAY_IS_FLOAT(in->array->typecode) ? in->array->typecode : NDARRAY_FLOAT;
+        ndarray_obj_t *out = numerical_reduce_axis(in, ax, typecode, &outer, &inner);
+        for(size_t o=0, k=0; o < outer; o++) {
+            for(size_t i=0; i < inner; i++, k++) {
+                size_t start = o*len*inner + i;
+                mp_float_t value = numerical_sum_mean_std_single_line(in->items, start, start+len*inner, 
+                                                                inner, in->array->typecode, optype);
+                ndarray_set_float_value(out->items, typecode, k, value);
             }
         }
-    return MP_OBJ_FROM_PTR(out);
+        return MP_OBJ_FROM_PTR(out);
     }
 }
 
@@ -161,15 +190,23 @@ size_t numerical_argmin_argmax_array(ndarray_obj_t *in, size_t start,
                                        size_t stop, size_t stride, uint8_t op) {
     size_t best_idx = start;
     if(in->array->typecode == NDARRAY_UINT8) {
-        ARG_MIN_LOOP(in, uint8_t, start, stop, stride, op);
+        ARG_MIN_LOOP(in, uint8_t, start, stop, stride, op, NUMERICAL_VALUE);
     } else if(in->array->typecode == NDARRAY_INT8) {
-        ARG_MIN_LOOP(in, int8_t, start, stop, stride, op);
+        ARG_MIN_LOOP(in, int8_t, start, stop, stride, op, NUMERICAL_VALUE);
     } else if(in->array->typecode == NDARRAY_UINT16) {
-        ARG_MIN_LOOP(in, uint16_t, start, stop, stride, op);
+        ARG_MIN_LOOP(in, uint16_t, start, stop, stride, op, NUMERICAL_VALUE);
     } else if(in->array->typecode == NDARRAY_INT16) {
-        ARG_MIN_LOOP(in, uint16_t, start, stop, stride, op);
+        ARG_MIN_LOOP(in, int16_t, start, stop, stride, op, NUMERICAL_VALUE);
+    } else if(in->array->typecode == NDARRAY_UINT32) {
+        ARG_MIN_LOOP(in, uint32_t, start, stop, stride, op, NUMERICAL_VALUE);
+    } else if(in->array->typecode == NDARRAY_INT32) {
+        ARG_MIN_LOOP(in, int32_t, start, stop, stride, op, NUMERICAL_VALUE);
+    } else if(in->array->typecode == NDARRAY_FLOAT16) {
+        ARG_MIN_LOOP(in, uint16_t, start, stop, stride, op, NUMERICAL_FLOAT16_VALUE);
+    } else if(NDARRAY_IS_FLOAT32(in->array->typecode)) {
+        ARG_MIN_LOOP(in, float, start, stop, stride, op, NUMERICAL_VALUE);
     } else if(in->array->typecode == NDARRAY_FLOAT) {
-        ARG_MIN_LOOP(in, mp_float_t, start, stop, stride, op);
+        ARG_MIN_LOOP(in, mp_float_t, start, stop, stride, op, NUMERICAL_VALUE);
     }
     return best_idx;
 }
@@ -178,12 +215,15 @@ void copy_value_into_ndarray(ndarray_obj_t *target, ndarray_obj_t *source, size_
     // since we are simply copying, it doesn't matter, whether the arrays are signed or unsigned, 
     // we can cast them in any way we like
     // This could also be done with byte copies. I don't know, whether that would have any benefits
-    if((target->array->typecode == NDARRAY_UINT8) || (target->array->typecode == NDARRAY_INT8)) {
-        ((uint8_t *)target->array->items)[target_idx] = ((uint8_t *)source->array->items)[source_idx];
-    } else if((target->array->typecode == NDARRAY_UINT16) || (target->array->typecode == NDARRAY_INT16)) {
-        ((uint16_t *)target->array->items)[target_idx] = ((uint16_t *)source->array->items)[source_idx];
+    uint8_t _sizeof = ndarray_itemsize(target->array->typecode);
+    if(_sizeof == 1) {
+        ((uint8_t *)target->items)[target_idx] = ((uint8_t *)source->items)[source_idx];
+    } else if(_sizeof == 2) {
+        ((uint16_t *)target->items)[target_idx] = ((uint16_t *)source->items)[source_idx];
+    } else if(_sizeof == 4) {
+        ((uint32_t *)target->items)[target_idx] = ((uint32_t *)source->items)[source_idx];
     } else { 
-        ((float *)target->array->items)[target_idx] = ((float *)source->array->items)[source_idx];
+        ((uint64_t *)target->items)[target_idx] = ((uint64_t *)source->items)[source_idx];
     }
 }
  
@@ -211,50 +251,42 @@ STATIC mp_obj_t numerical_argmin_argmax(mp_obj_t oin, mp_obj_t axis, uint8_t opt
             return best_obj;
         }
     } else if(mp_obj_is_type(oin, &ulab_ndarray_type)) {
-            ndarray_obj_t *in = MP_OBJ_TO_PTR(oin);
+            ndarray_obj_t *in = ndarray_contiguous(MP_OBJ_TO_PTR(oin));
+            // complex numbers can't be ordered
+            ndarray_check_real(in);
             size_t best_idx;
-            if((axis == mp_const_none) || (in->m == 1) || (in->n == 1)) {
+            if(numerical_is_flat(in, axis)) {
                 // return the value for the flattened array                
-                best_idx = numerical_argmin_argmax_array(in, 0, in->array->len, 1, optype);
+                best_idx = numerical_argmin_argmax_array(in, 0, in->len, 1, optype);
                 if((optype == NUMERICAL_ARGMIN) || (optype == NUMERICAL_ARGMAX)) {
                     return MP_OBJ_NEW_SMALL_INT(best_idx);
                 } else {
-                    if(in->array->typecode == NDARRAY_FLOAT) {
-                        return mp_obj_new_float(ndarray_get_float_value(in->array->items, in->array->typecode, best_idx));
+                    if(NDARRAY_IS_FLOAT(in->array->typecode)) {
+                        return mp_obj_new_float(ndarray_get_float_value(in->items, in->array->typecode, best_idx));
                     } else {
-                        return mp_binary_get_val_array(in->array->typecode, in->array->items, best_idx);
+                        return ndarray_get_value(in->array->typecode, in->items, best_idx);
                     }
                 }
             } else { // we have to work with a full matrix here
-                uint8_t _axis = mp_obj_get_int(axis);
-                size_t m = (_axis == 0) ? 1 : in->m;
-                size_t n = (_axis == 0) ? in->n : 1;
-                size_t len = in->array->len;
+                uint8_t ax = ndarray_normalise_axis(in, axis);
+                size_t outer, inner, len = in->shape[ax];
                 ndarray_obj_t *ndarray = NULL;
                 if((optype == NUMERICAL_MAX) || (optype == NUMERICAL_MIN)) {
-                    ndarray = create_new_ndarray(m, n, in->array->typecode);
+                    ndarray = numerical_reduce_axis(in, ax, in->array->typecode, &outer, &inner);
                 } else { // argmin/argmax
-                    // TODO: one might get away with uint8_t, if both m, and n < 255
-                    ndarray = create_new_ndarray(m, n, NDARRAY_UINT16);
+                    // TODO: one might get away with uint8_t, if the axis is shorter than 256
+                    ndarray = numerical_reduce_axis(in, ax, NDARRAY_UINT16, &outer, &inner);
                 }
-
-                // TODO: these two cases could probably be combined in a more elegant fashion...
-                if(_axis == 0) { // vertical
-                    for(size_t i=0; i < n; i++) {
-                        best_idx = numerical_argmin_argmax_array(in, i, len, n, optype);
-                        if((optype == NUMERICAL_MIN) || (optype == NUMERICAL_MAX)) {
-                            copy_value_into_ndarray(ndarray, in, i, best_idx);
-                        } else {
-                            ((uint16_t *)ndarray->array->items)[i] = (uint16_t)(best_idx / n);
-                        }
-                    }
-                } else { // horizontal
-                    for(size_t i=0; i < m; i++) {
-                        best_idx = numerical_argmin_argmax_array(in, i*in->n, (i+1)*in->n, 1, optype);
+                size_t out_idx = 0;
+                for(size_t o=0; o < outer; o++) {
+                    for(size_t i=0; i < inner; i++, out_idx++) {
+                        size_t start = o*len*inner + i;
+                        best_idx = numerical_argmin_argmax_array(in, start, start+len*inner, inner, optype);
                         if((optype == NUMERICAL_MIN) || (optype == NUMERICAL_MAX)) {
-                             copy_value_into_ndarray(ndarray, in, i, best_idx);
+                            copy_value_into_ndarray(ndarray, in, out_idx, best_idx);
                         } else {
-                            ((uint16_t *)ndarray->array->items)[i] = (uint16_t)(best_idx - i*in->n);
+                            // the index is counted along the axis
+                            ((uint16_t *)ndarray->items)[out_idx] = (uint16_t)((best_idx - start) / inner);
                         }
                     }
                 }
@@ -276,8 +308,10 @@ STATIC mp_obj_t numerical_function(size_t n_args, const mp_obj_t *pos_args, mp_m
     
     mp_obj_t oin = args[0].u_obj;
     mp_obj_t axis = args[1].u_obj;
-    if((axis != mp_const_none) && (mp_obj_get_int(axis) != 0) && (mp_obj_get_int(axis) != 1)) {
+    if((axis != mp_const_none) && !MP_OBJ_IS_TYPE(oin, &ulab_ndarray_type) && 
+       !MP_OBJ_IS_TYPE(oin, &ulab_lazy_type) && (mp_obj_get_int(axis) != 0) && (mp_obj_get_int(axis) != 1)) {
         // this seems to pass with False, and True...
+        // for ndarrays, the axis is checked against the number of dimensions later
         mp_raise_ValueError("axis must be None, 0, or 1");
     }
     
@@ -296,7 +330,16 @@ STATIC mp_obj_t numerical_function(size_t n_args, const mp_obj_t *pos_args, mp_m
             default: // we should never reach this point, but whatever
                 return mp_const_none;
         }
-    } else if(MP_OBJ_IS_TYPE(oin, &ulab_ndarray_type)) {
+    }
+    if(MP_OBJ_IS_TYPE(oin, &ulab_lazy_type)) {
+        // the flattened lazy array is reduced, while it is being computed, otherwise, 
+        // the reduction is done on the computed array
+        if(axis == mp_const_none) {
+            return evaluate_lazy_reduce(oin, type);
+        }
+        oin = evaluate_lazy_run(oin, mp_const_none);
+    }
+    if(MP_OBJ_IS_TYPE(oin, &ulab_ndarray_type)) {
         switch(type) {
             case NUMERICAL_MIN:
             case NUMERICAL_MAX:
@@ -362,11 +405,16 @@ mp_obj_t numerical_roll(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_ar
         mp_raise_ValueError("axis must be None, 0, or 1");
     }
 
-    ndarray_obj_t *in = MP_OBJ_TO_PTR(oin);
-    uint8_t _sizeof = mp_binary_get_size('@', in->array->typecode, NULL);
+    ndarray_obj_t *self = MP_OBJ_TO_PTR(oin);
+    if((self->ndim > 2) && (args[2].u_obj != mp_const_none)) {
+        mp_raise_ValueError("axis is supported for 1D, and 2D arrays only");
+    }
+    // views are rolled in a compact copy, whose content is then written back
+    ndarray_obj_t *in = ndarray_contiguous(self);
+    uint8_t _sizeof = ndarray_itemsize(in->array->typecode);
     size_t len;
     int16_t _shift;
-    uint8_t *array = (uint8_t *)in->array->items;
+    uint8_t *array = (uint8_t *)in->items;
     // TODO: transpose the matrix, if axis == 0. Though, that is hard on the RAM...
     if(shift < 0) {
         _shift = -shift;
@@ -376,11 +424,11 @@ mp_obj_t numerical_roll(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_ar
     if((args[2].u_obj == mp_const_none) || (mp_obj_get_int(args[2].u_obj) == 1)) { // shift horizontally
         uint16_t M;
         if(args[2].u_obj == mp_const_none) {
-            len = in->array->len;
+            len = in->len;
             M = 1;
         } else {
-            len = in->n;
-            M = in->m;
+            len = COLUMNS(in);
+            M = ROWS(in);
         }
         _shift = _shift % len;
         if(shift < 0) _shift = len - _shift;
@@ -393,9 +441,12 @@ mp_obj_t numerical_roll(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_ar
             memmove(&array[(m+1)*len*_sizeof-_shift], tmp, _shift);
         }
         m_del(uint8_t, tmp, _shift);
+        if(in != self) {
+            ndarray_copy_elements(self, in);
+        }
         return mp_const_none;
     } else {
-        len = in->m;
+        len = ROWS(in);
         // temporary buffer
         uint8_t *_data = m_new(uint8_t, _sizeof*len);
         
@@ -404,10 +455,10 @@ mp_obj_t numerical_roll(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_ar
         _shift *= _sizeof;
         uint8_t *tmp = m_new(uint8_t, _shift);
 
-        for(size_t n=0; n < in->n; n++) {
+        for(size_t n=0; n < COLUMNS(in); n++) {
             for(size_t m=0; m < len; m++) {
                 // this loop should fill up the temporary buffer
-                memmove(&_data[m*_sizeof], &array[(m*in->n+n)*_sizeof], _sizeof);
+                memmove(&_data[m*_sizeof], &array[(m*COLUMNS(in)+n)*_sizeof], _sizeof);
             }
             // now, the actual shift
             memmove(tmp, _data, _shift);
@@ -415,11 +466,14 @@ mp_obj_t numerical_roll(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_ar
             memmove(&_data[len*_sizeof-_shift], tmp, _shift);
             for(size_t m=0; m < len; m++) {
                 // this loop should dump the content of the temporary buffer into data
-                memmove(&array[(m*in->n+n)*_sizeof], &_data[m*_sizeof], _sizeof);
+                memmove(&array[(m*COLUMNS(in)+n)*_sizeof], &_data[m*_sizeof], _sizeof);
             }            
         }
         m_del(uint8_t, tmp, _shift);
         m_del(uint8_t, _data, _sizeof*len);
+        if(in != self) {
+            ndarray_copy_elements(self, in);
+        }
         return mp_const_none;
     }
 }
@@ -442,18 +496,20 @@ mp_obj_t numerical_flip(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_ar
         mp_raise_ValueError("axis must be None, 0, or 1");
     }
 
-    ndarray_obj_t *in = MP_OBJ_TO_PTR(args[0].u_obj);
-    mp_obj_t oout = ndarray_copy(args[0].u_obj);
-    ndarray_obj_t *out = MP_OBJ_TO_PTR(oout);
-    uint8_t _sizeof = mp_binary_get_size('@', in->array->typecode, NULL);
-    uint8_t *array_in = (uint8_t *)in->array->items;
-    uint8_t *array_out = (uint8_t *)out->array->items;    
+    ndarray_obj_t *in = ndarray_contiguous(MP_OBJ_TO_PTR(args[0].u_obj));
+    if((in->ndim > 2) && (args[1].u_obj != mp_const_none)) {
+        mp_raise_ValueError("axis is supported for 1D, and 2D arrays only");
+    }
+    ndarray_obj_t *out = ndarray_new_empty(in->ndim, in->shape, in->array->typecode);
+    uint8_t _sizeof = ndarray_itemsize(in->array->typecode);
+    uint8_t *array_in = (uint8_t *)in->items;
+    uint8_t *array_out = (uint8_t *)out->items;
     size_t len;
     if((args[1].u_obj == mp_const_none) || (mp_obj_get_int(args[1].u_obj) == 1)) { // flip horizontally
-        uint16_t M = in->m;
-        len = in->n;
+        uint16_t M = ROWS(in);
+        len = COLUMNS(in);
         if(args[1].u_obj == mp_const_none) { // flip flattened array
-            len = in->array->len;
+            len = in->len;
             M = 1;
         }
         for(size_t m=0; m < M; m++) {
@@ -462,13 +518,13 @@ mp_obj_t numerical_flip(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_ar
             }
         }
     } else { // flip vertically
-        for(size_t m=0; m < in->m; m++) {
-            for(size_t n=0; n < in->n; n++) {
-                memcpy(array_out+_sizeof*(m*in->n+n), array_in+_sizeof*((in->m-m-1)*in->n+n), _sizeof);
+        for(size_t m=0; m < ROWS(in); m++) {
+            for(size_t n=0; n < COLUMNS(in); n++) {
+                memcpy(array_out+_sizeof*(m*COLUMNS(in)+n), array_in+_sizeof*((ROWS(in)-m-1)*COLUMNS(in)+n), _sizeof);
             }
         }
     }
-    return out;
+    return MP_OBJ_FROM_PTR(out);
 }
 
 mp_obj_t numerical_diff(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
@@ -485,12 +541,16 @@ mp_obj_t numerical_diff(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_ar
         mp_raise_TypeError("diff argument must be an ndarray");
     }
     
-    ndarray_obj_t *in = MP_OBJ_TO_PTR(args[0].u_obj);
+    ndarray_obj_t *in = ndarray_contiguous(MP_OBJ_TO_PTR(args[0].u_obj));
+    ndarray_check_real(in);
+    if(in->ndim > 2) {
+        mp_raise_ValueError("diff is implemented for 1D, and 2D arrays only");
+    }
     size_t increment, N, M;
     if((args[2].u_int == -1) || (args[2].u_int == 1)) { // differentiate along the horizontal axis
         increment = 1;
     } else if(args[2].u_int == 0) { // differtiate along vertical axis
-        increment = in->n;
+        increment = COLUMNS(in);
     } else {
         mp_raise_ValueError("axis must be -1, 0, or 1");        
     }
@@ -507,33 +567,50 @@ mp_obj_t numerical_diff(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_ar
     ndarray_obj_t *out;
     
     if(increment == 1) { // differentiate along the horizontal axis 
-        if(n >= in->n) {
-            out = create_new_ndarray(in->m, 0, in->array->typecode);
+        if(n >= COLUMNS(in)) {
+            out = create_new_ndarray(ROWS(in), 0, in->array->typecode);
             m_del(uint8_t, stencil, n);
             return MP_OBJ_FROM_PTR(out);
         }
-        N = in->n - n;
-        M = in->m;
+        N = COLUMNS(in) - n;
+        M = ROWS(in);
     } else { // differentiate along vertical axis
-        if(n >= in->m) {
-            out = create_new_ndarray(0, in->n, in->array->typecode);
+        if(n >= ROWS(in)) {
+            out = create_new_ndarray(0, COLUMNS(in), in->array->typecode);
             m_del(uint8_t, stencil, n);
             return MP_OBJ_FROM_PTR(out);
         }
-        M = in->m - n;
-        N = in->n;
+        M = ROWS(in) - n;
+        N = COLUMNS(in);
     }
     out = create_new_ndarray(M, N, in->array->typecode);
     if(in->array->typecode == NDARRAY_UINT8) {
-        CALCULATE_DIFF(in, out, uint8_t, M, N, in->n, increment);
+        CALCULATE_DIFF(in, out, uint8_t, M, N, COLUMNS(in), increment);
     } else if(in->array->typecode == NDARRAY_INT8) {
-        CALCULATE_DIFF(in, out, int8_t, M, N, in->n, increment);
+        CALCULATE_DIFF(in, out, int8_t, M, N, COLUMNS(in), increment);
     }  else if(in->array->typecode == NDARRAY_UINT16) {
-        CALCULATE_DIFF(in, out, uint16_t, M, N, in->n, increment);
+        CALCULATE_DIFF(in, out, uint16_t, M, N, COLUMNS(in), increment);
     } else if(in->array->typecode == NDARRAY_INT16) {
-        CALCULATE_DIFF(in, out, int16_t, M, N, in->n, increment);
+        CALCULATE_DIFF(in, out, int16_t, M, N, COLUMNS(in), increment);
+    } else if(in->array->typecode == NDARRAY_UINT32) {
+        CALCULATE_DIFF(in, out, uint32_t, M, N, COLUMNS(in), increment);
+    } else if(in->array->typecode == NDARRAY_INT32) {
+        CALCULATE_DIFF(in, out, int32_t, M, N, COLUMNS(in), increment);
+    } else if(in->array->typecode == NDARRAY_FLOAT16) {
+        // float16 has no arithmetic in C, so the differences are calculated in mp_float_t
+        for(size_t i=0; i < M; i++) {
+            for(size_t j=0; j < N; j++) {
+                mp_float_t value = 0.0;
+                for(uint8_t k=0; k < n+1; k++) {
+                    value -= stencil[k]*ndarray_get_float_value(in->items, NDARRAY_FLOAT16, i*COLUMNS(in)+j+k*increment);
+                }
+                ndarray_set_float_value(out->items, NDARRAY_FLOAT16, i*N+j, value);
+            }
+        }
+    } else if(NDARRAY_IS_FLOAT32(in->array->typecode)) {
+        CALCULATE_DIFF(in, out, float, M, N, COLUMNS(in), increment);
     } else {
-        CALCULATE_DIFF(in, out, mp_float_t, M, N, in->n, increment);
+        CALCULATE_DIFF(in, out, mp_float_t, M, N, COLUMNS(in), increment);
     }
     m_del(int8_t, stencil, n);
     return MP_OBJ_FROM_PTR(out);
@@ -543,34 +620,51 @@ mp_obj_t numerical_sort_helper(mp_obj_t oin, mp_obj_t axis, uint8_t inplace) {
     if(!mp_obj_is_type(oin, &ulab_ndarray_type)) {
         mp_raise_TypeError("sort argument must be an ndarray");
     }
+    ndarray_check_real(MP_OBJ_TO_PTR(oin));
 
     ndarray_obj_t *ndarray;
     mp_obj_t out;
     if(inplace == 1) {
         ndarray = MP_OBJ_TO_PTR(oin);
+        if(!ndarray_is_dense(ndarray)) {
+            // views are sorted in a compact copy, whose content is then written back
+            ndarray_obj_t *sorted = MP_OBJ_TO_PTR(numerical_sort_helper(oin, axis, 0));
+            if(axis == mp_const_none) {
+                // the sorted copy is flat, but it has to be written back into the original shape
+                sorted = MP_OBJ_TO_PTR(linalg_reshape(MP_OBJ_FROM_PTR(sorted), ndarray_shape(oin)));
+            }
+            ndarray_copy_elements(ndarray, sorted);
+            return mp_const_none;
+        }
     } else {
         out = ndarray_copy(oin);
         ndarray = MP_OBJ_TO_PTR(out);
     }
     size_t increment, start_inc, end, N;
     if(axis == mp_const_none) { // flatten the array
-        ndarray->m = 1;
-        ndarray->n = ndarray->array->len;
+        ndarray->ndim = 2;
+        for(uint8_t i=0; i < ULAB_MAX_DIMS-1; i++) {
+            ndarray->shape[i] = 1;
+            ndarray->strides[i] = ndarray->len;
+        }
+        COLUMNS(ndarray) = ndarray->len;
         increment = 1;
-        start_inc = ndarray->n;
-        end = ndarray->n;
-        N = ndarray->n;
+        start_inc = COLUMNS(ndarray);
+        end = COLUMNS(ndarray);
+        N = COLUMNS(ndarray);
+    } else if(ndarray->ndim > 2) {
+        mp_raise_ValueError("axis is supported for 1D, and 2D arrays only");
     } else if((mp_obj_get_int(axis) == -1) || 
               (mp_obj_get_int(axis) == 1)) { // sort along the horizontal axis
         increment = 1;
-        start_inc = ndarray->n;
-        end = ndarray->array->len;
-        N = ndarray->n;
+        start_inc = COLUMNS(ndarray);
+        end = ndarray->len;
+        N = COLUMNS(ndarray);
     } else if(mp_obj_get_int(axis) == 0) { // sort along vertical axis
-        increment = ndarray->n;
+        increment = COLUMNS(ndarray);
         start_inc = 1;
-        end = ndarray->m;
-        N = ndarray->m;
+        end = ROWS(ndarray);
+        N = ROWS(ndarray);
     } else {
         mp_raise_ValueError("axis must be -1, 0, None, or 1");        
     }
@@ -580,12 +674,24 @@ mp_obj_t numerical_sort_helper(mp_obj_t oin, mp_obj_t axis, uint8_t inplace) {
     for(size_t start=0; start < end; start+=start_inc) {
         q = N; 
         k = (q >> 1);
-        if((ndarray->array->typecode == NDARRAY_UINT8) || (ndarray->array->typecode == NDARRAY_INT8)) {
-            HEAPSORT(uint8_t, ndarray);
-        } else if((ndarray->array->typecode == NDARRAY_INT16) || (ndarray->array->typecode == NDARRAY_INT16)) {
-            HEAPSORT(uint16_t, ndarray);
+        if(ndarray->array->typecode == NDARRAY_UINT8) {
+            HEAPSORT(uint8_t, ndarray, NUMERICAL_VALUE);
+        } else if(ndarray->array->typecode == NDARRAY_INT8) {
+            HEAPSORT(int8_t, ndarray, NUMERICAL_VALUE);
+        } else if(ndarray->array->typecode == NDARRAY_UINT16) {
+            HEAPSORT(uint16_t, ndarray, NUMERICAL_VALUE);
+        } else if(ndarray->array->typecode == NDARRAY_INT16) {
+            HEAPSORT(int16_t, ndarray, NUMERICAL_VALUE);
+        } else if(ndarray->array->typecode == NDARRAY_UINT32) {
+            HEAPSORT(uint32_t, ndarray, NUMERICAL_VALUE);
+        } else if(ndarray->array->typecode == NDARRAY_INT32) {
+            HEAPSORT(int32_t, ndarray, NUMERICAL_VALUE);
+        } else if(ndarray->array->typecode == NDARRAY_FLOAT16) {
+            HEAPSORT(uint16_t, ndarray, NUMERICAL_FLOAT16_VALUE);
+        } else if(NDARRAY_IS_FLOAT32(ndarray->array->typecode)) {
+            HEAPSORT(float, ndarray, NUMERICAL_VALUE);
         } else {
-            HEAPSORT(mp_float_t, ndarray);
+            HEAPSORT(mp_float_t, ndarray, NUMERICAL_VALUE);
         }
     }
     if(inplace == 1) {
@@ -631,28 +737,29 @@ mp_obj_t numerical_argsort(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw
         mp_raise_TypeError("argsort argument must be an ndarray");
     }
 
-    ndarray_obj_t *ndarray = MP_OBJ_TO_PTR(args[0].u_obj);
+    ndarray_obj_t *ndarray = ndarray_contiguous(MP_OBJ_TO_PTR(args[0].u_obj));
+    ndarray_check_real(ndarray);
     size_t increment, start_inc, end, N, m, n;
     if(args[1].u_obj == mp_const_none) { // flatten the array
         m = 1;
-        n = ndarray->array->len;
-        ndarray->m = m;
-        ndarray->n = n;
+        n = ndarray->len;
         increment = 1;
-        start_inc = ndarray->n;
-        end = ndarray->n;
+        start_inc = n;
+        end = n;
         N = n;
+    } else if(ndarray->ndim > 2) {
+        mp_raise_ValueError("axis is supported for 1D, and 2D arrays only");
     } else if((mp_obj_get_int(args[1].u_obj) == -1) || 
               (mp_obj_get_int(args[1].u_obj) == 1)) { // sort along the horizontal axis
-        m = ndarray->m;
-        n = ndarray->n;
+        m = ROWS(ndarray);
+        n = COLUMNS(ndarray);
         increment = 1;
         start_inc = n;
-        end = ndarray->array->len;
+        end = ndarray->len;
         N = n;
     } else if(mp_obj_get_int(args[1].u_obj) == 0) { // sort along vertical axis
-        m = ndarray->m;
-        n = ndarray->n;
+        m = ROWS(ndarray);
+        n = COLUMNS(ndarray);
         increment = n;
         start_inc = 1;
         end = m;
@@ -664,9 +771,9 @@ mp_obj_t numerical_argsort(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw
     // at the expense of flash, we could save RAM by creating 
     // an NDARRAY_UINT16 ndarray only, if needed, otherwise, NDARRAY_UINT8
     ndarray_obj_t *indices = create_new_ndarray(m, n, NDARRAY_UINT16);
-    uint16_t *index_array = (uint16_t *)indices->array->items;
+    uint16_t *index_array = (uint16_t *)indices->items;
     // initialise the index array
-    // if array is flat: 0 to indices->n
+    // if array is flat: 0 to the number of columns of indices
     // if sorting vertically, identical indices are arranged row-wise
     // if sorting horizontally, identical indices are arranged colunn-wise
     for(uint16_t start=0; start < end; start+=start_inc) {
@@ -679,12 +786,24 @@ mp_obj_t numerical_argsort(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw
     for(size_t start=0; start < end; start+=start_inc) {
         q = N; 
         k = (q >> 1);
-        if((ndarray->array->typecode == NDARRAY_UINT8) || (ndarray->array->typecode == NDARRAY_INT8)) {
-            HEAP_ARGSORT(uint8_t, ndarray, index_array);
-        } else if((ndarray->array->typecode == NDARRAY_INT16) || (ndarray->array->typecode == NDARRAY_INT16)) {
-            HEAP_ARGSORT(uint16_t, ndarray, index_array);
+        if(ndarray->array->typecode == NDARRAY_UINT8) {
+            HEAP_ARGSORT(uint8_t, ndarray, index_array, NUMERICAL_VALUE);
+        } else if(ndarray->array->typecode == NDARRAY_INT8) {
+            HEAP_ARGSORT(int8_t, ndarray, index_array, NUMERICAL_VALUE);
+        } else if(ndarray->array->typecode == NDARRAY_UINT16) {
+            HEAP_ARGSORT(uint16_t, ndarray, index_array, NUMERICAL_VALUE);
+        } else if(ndarray->array->typecode == NDARRAY_INT16) {
+            HEAP_ARGSORT(int16_t, ndarray, index_array, NUMERICAL_VALUE);
+        } else if(ndarray->array->typecode == NDARRAY_UINT32) {
+            HEAP_ARGSORT(uint32_t, ndarray, index_array, NUMERICAL_VALUE);
+        } else if(ndarray->array->typecode == NDARRAY_INT32) {
+            HEAP_ARGSORT(int32_t, ndarray, index_array, NUMERICAL_VALUE);
+        } else if(ndarray->array->typecode == NDARRAY_FLOAT16) {
+            HEAP_ARGSORT(uint16_t, ndarray, index_array, NUMERICAL_FLOAT16_VALUE);
+        } else if(NDARRAY_IS_FLOAT32(ndarray->array->typecode)) {
+            HEAP_ARGSORT(float, ndarray, index_array, NUMERICAL_VALUE);
         } else {
-            HEAP_ARGSORT(mp_float_t, ndarray, index_array);
+            HEAP_ARGSORT(mp_float_t, ndarray, index_array, NUMERICAL_VALUE);
         }
     }
     return MP_OBJ_FROM_PTR(indices);
@@ -13,6 +13,16 @@
 
 #include "ndarray.h"
 
+enum NUMERICAL_FUNCTION_TYPE {
+    NUMERICAL_MIN,
+    NUMERICAL_MAX,
+    NUMERICAL_ARGMIN,
+    NUMERICAL_ARGMAX,
+    NUMERICAL_SUM,
+    NUMERICAL_MEAN,
+    NUMERICAL_STD,
+};
+
 mp_obj_t numerical_linspace(size_t , const mp_obj_t *, mp_map_t *);
 mp_obj_t numerical_sum(size_t , const mp_obj_t *, mp_map_t *);
 mp_obj_t numerical_mean(size_t , const mp_obj_t *, mp_map_t *);
@@ -33,25 +43,30 @@ mp_obj_t numerical_sort(size_t , const mp_obj_t *, mp_map_t *);
 mp_obj_t numerical_sort_inplace(size_t , const mp_obj_t *, mp_map_t *);
 mp_obj_t numerical_argsort(size_t , const mp_obj_t *, mp_map_t *);
 
+// The sorting, and searching macros compare key(value) instead of the stored values, so that 
+// types without arithmetic in C, i.e., float16, can be handled by the same code
+#define NUMERICAL_VALUE(x) (x)
+#define NUMERICAL_FLOAT16_VALUE(x) ndarray_float16_to_float(x)
+
 // this macro could be tighter, if we moved the ifs to the argmin function, assigned <, as well as >
-#define ARG_MIN_LOOP(in, type, start, stop, stride, op) do {\
-    type *array = (type *)(in)->array->items;\
+#define ARG_MIN_LOOP(in, type, start, stop, stride, op, key) do {\
+    type *array = (type *)(in)->items;\
     if(((op) == NUMERICAL_MAX) || ((op) == NUMERICAL_ARGMAX)) {\
         for(size_t i=(start)+(stride); i < (stop); i+=(stride)) {\
-            if((array)[i] > (array)[best_idx]) {\
+            if(key((array)[i]) > key((array)[best_idx])) {\
                 best_idx = i;\
             }\
         }\
     } else{\
         for(size_t i=(start)+(stride); i < (stop); i+=(stride)) {\
-            if((array)[i] < (array)[best_idx]) best_idx = i;\
+            if(key((array)[i]) < key((array)[best_idx])) best_idx = i;\
         }\
     }\
 } while(0)
 
 #define CALCULATE_DIFF(in, out, type, M, N, inn, increment) do {\
-    type *source = (type *)(in)->array->items;\
-    type *target = (type *)(out)->array->items;\
+    type *source = (type *)(in)->items;\
+    type *target = (type *)(out)->items;\
     for(size_t i=0; i < (M); i++) {\
         for(size_t j=0; j < (N); j++) {\
             for(uint8_t k=0; k < n+1; k++) {\
@@ -61,8 +76,8 @@ mp_obj_t numerical_argsort(size_t , const mp_obj_t *, mp_map_t *);
     }\
 } while(0)
 
-#define HEAPSORT(type, ndarray) do {\
-    type *array = (type *)(ndarray)->array->items;\
+#define HEAPSORT(type, ndarray, key) do {\
+    type *array = (type *)(ndarray)->items;\
     type tmp;\
     for (;;) {\
         if (k > 0) {\
@@ -78,10 +93,10 @@ mp_obj_t numerical_argsort(size_t , const mp_obj_t *, mp_map_t *);
         p = k;\
         c = k + k + 1;\
         while (c < q) {\
-            if((c + 1 < q)  &&  (array[start+(c+1)*increment] > array[start+c*increment])) {\
+            if((c + 1 < q)  &&  (key(array[start+(c+1)*increment]) > key(array[start+c*increment]))) {\
                 c++;\
             }\
-            if(array[start+c*increment] > tmp) {\
+            if(key(array[start+c*increment]) > key(tmp)) {\
                 array[start+p*increment] = array[start+c*increment];\
                 p = c;\
                 c = p + p + 1;\
@@ -96,8 +111,8 @@ mp_obj_t numerical_argsort(size_t , const mp_obj_t *, mp_map_t *);
 // This is pretty similar to HEAPSORT above; perhaps, the two could be combined somehow
 // On the other hand, since this is a macro, it doesn't really matter
 // Keep in mind that initially, index_array[start+s*increment] = s
-#define HEAP_ARGSORT(type, ndarray, index_array) do {\
-    type *array = (type *)(ndarray)->array->items;\
+#define HEAP_ARGSORT(type, ndarray, index_array, key) do {\
+    type *array = (type *)(ndarray)->items;\
     type tmp;\
     uint16_t itmp;\
     for (;;) {\
@@ -117,10 +132,10 @@ mp_obj_t numerical_argsort(size_t , const mp_obj_t *, mp_map_t *);
         p = k;\
         c = k + k + 1;\
         while (c < q) {\
-            if((c + 1 < q)  &&  (array[start+index_array[start+(c+1)*increment]*increment] > array[start+index_array[start+c*increment]*increment])) {\
+            if((c + 1 < q)  &&  (key(array[start+index_array[start+(c+1)*increment]*increment]) > key(array[start+index_array[start+c*increment]*increment]))) {\
                 c++;\
             }\
-            if(array[start+index_array[start+c*increment]*increment] > tmp) {\
+            if(key(array[start+index_array[start+c*increment]*increment]) > key(tmp)) {\
                 index_array[start+p*increment] = index_array[start+c*increment];\
                 p = c;\
                 c = p + p + 1;\
@@ -29,7 +29,7 @@ bool object_is_nditerable(mp_obj_t o_in) {
 size_t get_nditerable_len(mp_obj_t o_in) {
     if(mp_obj_is_type(o_in, &ulab_ndarray_type)) {
         ndarray_obj_t *in = MP_OBJ_TO_PTR(o_in);
-        return in->array->len;
+        return in->len;
     } else {
         return (size_t)mp_obj_get_int(mp_obj_len_maybe(o_in));
     }
@@ -42,8 +42,11 @@ mp_obj_t poly_polyval(mp_obj_t o_p, mp_obj_t o_x) {
     size_t m, n;
     if(MP_OBJ_IS_TYPE(o_x, &ulab_ndarray_type)) {
         ndarray_obj_t *ndx = MP_OBJ_TO_PTR(o_x);
-        m = ndx->m;
-        n = ndx->n;
+        if(ndx->ndim > 2) {
+            mp_raise_ValueError("polyval is implemented for 1D, and 2D arrays only");
+        }
+        m = ROWS(ndx);
+        n = COLUMNS(ndx);
     } else {
         mp_obj_array_t *ix = MP_OBJ_TO_PTR(o_x);
         m = 1;
@@ -59,7 +62,7 @@ mp_obj_t poly_polyval(mp_obj_t o_p, mp_obj_t o_x) {
     mp_obj_t p_item, p_iterable;
 
     mp_float_t x, y;
-    mp_float_t *outf = (mp_float_t *)out->array->items;
+    mp_float_t *outf = (mp_float_t *)out->items;
     uint8_t plen = mp_obj_get_int(mp_obj_len_maybe(o_p));
     mp_float_t *p = m_new(mp_float_t, plen);
     p_iterable = mp_getiter(o_p, &p_buf);
@@ -171,7 +174,7 @@ mp_obj_t poly_polyfit(size_t  n_args, const mp_obj_t *args) {
     m_del(mp_float_t, XT, (deg+1)*leny);
     
     ndarray_obj_t *beta = create_new_ndarray(deg+1, 1, NDARRAY_FLOAT);
-    mp_float_t *betav = (mp_float_t *)beta->array->items;
+    mp_float_t *betav = (mp_float_t *)beta->items;
     // x[0..(deg+1)] contains now the product X^T * y; we can get rid of y
     m_del(float, y, leny);
     
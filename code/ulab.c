@@ -23,8 +23,9 @@
 #include "poly.h"
 #include "fft.h"
 #include "numerical.h"
+#include "evaluate.h"
 
-#define ULAB_VERSION 0.26
+#define ULAB_VERSION 0.52
 
 typedef struct _mp_obj_float_t {
     mp_obj_base_t base;
@@ -36,7 +37,26 @@ mp_obj_float_t ulab_version = {{&mp_type_float}, ULAB_VERSION};
 MP_DEFINE_CONST_FUN_OBJ_1(ndarray_shape_obj, ndarray_shape);
 MP_DEFINE_CONST_FUN_OBJ_1(ndarray_rawsize_obj, ndarray_rawsize);
 MP_DEFINE_CONST_FUN_OBJ_KW(ndarray_flatten_obj, 1, ndarray_flatten);
+MP_DEFINE_CONST_FUN_OBJ_KW(ndarray_astype_obj, 2, ndarray_astype);
 MP_DEFINE_CONST_FUN_OBJ_1(ndarray_asbytearray_obj, ndarray_asbytearray);
+MP_DEFINE_CONST_FUN_OBJ_1(ndarray_copy_obj, ndarray_copy);
+MP_DEFINE_CONST_FUN_OBJ_KW(ndarray_frombuffer_obj, 1, ndarray_frombuffer);
+MP_DEFINE_CONST_FUN_OBJ_KW(ndarray_add_obj, 2, ndarray_add);
+MP_DEFINE_CONST_FUN_OBJ_KW(ndarray_subtract_obj, 2, ndarray_subtract);
+MP_DEFINE_CONST_FUN_OBJ_KW(ndarray_multiply_obj, 2, ndarray_multiply);
+MP_DEFINE_CONST_FUN_OBJ_KW(ndarray_divide_obj, 2, ndarray_divide);
+MP_DEFINE_CONST_FUN_OBJ_KW(ndarray_equal_obj, 2, ndarray_equal);
+MP_DEFINE_CONST_FUN_OBJ_KW(ndarray_not_equal_obj, 2, ndarray_not_equal);
+MP_DEFINE_CONST_FUN_OBJ_KW(ndarray_take_obj, 2, ndarray_take);
+MP_DEFINE_CONST_FUN_OBJ_3(ndarray_put_obj, ndarray_put);
+MP_DEFINE_CONST_FUN_OBJ_KW(ndarray_take_along_axis_obj, 3, ndarray_take_along_axis);
+MP_DEFINE_CONST_FUN_OBJ_1(ndarray_real_obj, ndarray_real);
+MP_DEFINE_CONST_FUN_OBJ_1(ndarray_imag_obj, ndarray_imag);
+MP_DEFINE_CONST_FUN_OBJ_1(ndarray_conjugate_obj, ndarray_conjugate);
+MP_DEFINE_CONST_FUN_OBJ_1(ndarray_angle_obj, ndarray_angle);
+
+MP_DEFINE_CONST_FUN_OBJ_KW(evaluate_evaluate_obj, 1, evaluate_evaluate);
+MP_DEFINE_CONST_FUN_OBJ_KW(evaluate_lazy_compute_obj, 1, evaluate_lazy_compute);
 
 MP_DEFINE_CONST_FUN_OBJ_1(linalg_transpose_obj, linalg_transpose);
 MP_DEFINE_CONST_FUN_OBJ_2(linalg_reshape_obj, linalg_reshape);
@@ -45,33 +65,40 @@ MP_DEFINE_CONST_FUN_OBJ_1(linalg_inv_obj, linalg_inv);
 MP_DEFINE_CONST_FUN_OBJ_2(linalg_dot_obj, linalg_dot);
 MP_DEFINE_CONST_FUN_OBJ_KW(linalg_zeros_obj, 0, linalg_zeros);
 MP_DEFINE_CONST_FUN_OBJ_KW(linalg_ones_obj, 0, linalg_ones);
+MP_DEFINE_CONST_FUN_OBJ_KW(linalg_empty_obj, 0, linalg_empty);
 MP_DEFINE_CONST_FUN_OBJ_KW(linalg_eye_obj, 0, linalg_eye);
 MP_DEFINE_CONST_FUN_OBJ_1(linalg_det_obj, linalg_det);
 MP_DEFINE_CONST_FUN_OBJ_1(linalg_eig_obj, linalg_eig);
 
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_acos_obj, vectorise_acos);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_acosh_obj, vectorise_acosh);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_asin_obj, vectorise_asin);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_asinh_obj, vectorise_asinh);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_atan_obj, vectorise_atan);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_atanh_obj, vectorise_atanh);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_ceil_obj, vectorise_ceil);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_cos_obj, vectorise_cos);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_erf_obj, vectorise_erf);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_erfc_obj, vectorise_erfc);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_exp_obj, vectorise_exp);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_expm1_obj, vectorise_expm1);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_floor_obj, vectorise_floor);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_gamma_obj, vectorise_gamma);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_lgamma_obj, vectorise_lgamma);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_log_obj, vectorise_log);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_log10_obj, vectorise_log10);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_log2_obj, vectorise_log2);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_sin_obj, vectorise_sin);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_sinh_obj, vectorise_sinh);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_sqrt_obj, vectorise_sqrt);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_tan_obj, vectorise_tan);
-MP_DEFINE_CONST_FUN_OBJ_1(vectorise_tanh_obj, vectorise_tanh);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_acos_obj, 1, vectorise_acos);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_acosh_obj, 1, vectorise_acosh);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_asin_obj, 1, vectorise_asin);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_asinh_obj, 1, vectorise_asinh);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_atan_obj, 1, vectorise_atan);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_atanh_obj, 1, vectorise_atanh);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_atan2_obj, 2, vectorise_atan2);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_ceil_obj, 1, vectorise_ceil);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_copysign_obj, 2, vectorise_copysign);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_cos_obj, 1, vectorise_cos);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_erf_obj, 1, vectorise_erf);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_erfc_obj, 1, vectorise_erfc);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_exp_obj, 1, vectorise_exp);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_expm1_obj, 1, vectorise_expm1);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_floor_obj, 1, vectorise_floor);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_fmod_obj, 2, vectorise_fmod);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_gamma_obj, 1, vectorise_gamma);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_hypot_obj, 2, vectorise_hypot);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_lgamma_obj, 1, vectorise_lgamma);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_log_obj, 1, vectorise_log);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_log10_obj, 1, vectorise_log10);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_log2_obj, 1, vectorise_log2);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_pow_obj, 2, vectorise_pow);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_sin_obj, 1, vectorise_sin);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_sinh_obj, 1, vectorise_sinh);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_sqrt_obj, 1, vectorise_sqrt);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_tan_obj, 1, vectorise_tan);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_tanh_obj, 1, vectorise_tanh);
+MP_DEFINE_CONST_FUN_OBJ_KW(vectorise_vectorize_obj, 1, vectorise_vectorize);
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(numerical_linspace_obj, 2, numerical_linspace);
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(numerical_sum_obj, 1, numerical_sum);
@@ -100,6 +127,8 @@ STATIC const mp_rom_map_elem_t ulab_ndarray_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_rawsize), MP_ROM_PTR(&ndarray_rawsize_obj) },
     { MP_ROM_QSTR(MP_QSTR_flatten), MP_ROM_PTR(&ndarray_flatten_obj) },    
     { MP_ROM_QSTR(MP_QSTR_asbytearray), MP_ROM_PTR(&ndarray_asbytearray_obj) },
+    { MP_ROM_QSTR(MP_QSTR_copy), MP_ROM_PTR(&ndarray_copy_obj) },
+    { MP_ROM_QSTR(MP_QSTR_astype), MP_ROM_PTR(&ndarray_astype_obj) },
     { MP_ROM_QSTR(MP_QSTR_transpose), MP_ROM_PTR(&linalg_transpose_obj) },
     { MP_ROM_QSTR(MP_QSTR_reshape), MP_ROM_PTR(&linalg_reshape_obj) },
     { MP_ROM_QSTR(MP_QSTR_sort), MP_ROM_PTR(&numerical_sort_inplace_obj) },
@@ -116,18 +145,56 @@ const mp_obj_type_t ulab_ndarray_type = {
     .getiter = ndarray_getiter,
     .unary_op = ndarray_unary_op,
     .binary_op = ndarray_binary_op,
+    .buffer_p = { .get_buffer = ndarray_get_buffer, },
     .locals_dict = (mp_obj_dict_t*)&ulab_ndarray_locals_dict,
 };
 
+STATIC const mp_rom_map_elem_t ulab_lazy_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_compute), MP_ROM_PTR(&evaluate_lazy_compute_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(ulab_lazy_locals_dict, ulab_lazy_locals_dict_table);
+
+const mp_obj_type_t ulab_lazy_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_lazy,
+    .print = evaluate_lazy_print,
+    .make_new = evaluate_lazy_make_new,
+    .unary_op = evaluate_lazy_unary_op,
+    .binary_op = evaluate_lazy_binary_op,
+    .locals_dict = (mp_obj_dict_t*)&ulab_lazy_locals_dict,
+};
+
+const mp_obj_type_t ulab_vectorized_function_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_vectorized_function,
+    .call = vectorise_vectorized_function_call,
+};
+
 STATIC const mp_map_elem_t ulab_globals_table[] = {
     { MP_OBJ_NEW_QSTR(MP_QSTR___name__), MP_OBJ_NEW_QSTR(MP_QSTR_ulab) },
     { MP_ROM_QSTR(MP_QSTR___version__), MP_ROM_PTR(&ulab_version) },
     { MP_OBJ_NEW_QSTR(MP_QSTR_array), (mp_obj_t)&ulab_ndarray_type },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_frombuffer), (mp_obj_t)&ndarray_frombuffer_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_add), (mp_obj_t)&ndarray_add_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_subtract), (mp_obj_t)&ndarray_subtract_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_multiply), (mp_obj_t)&ndarray_multiply_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_divide), (mp_obj_t)&ndarray_divide_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_equal), (mp_obj_t)&ndarray_equal_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_not_equal), (mp_obj_t)&ndarray_not_equal_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_take), (mp_obj_t)&ndarray_take_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_put), (mp_obj_t)&ndarray_put_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_take_along_axis), (mp_obj_t)&ndarray_take_along_axis_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_real), (mp_obj_t)&ndarray_real_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_imag), (mp_obj_t)&ndarray_imag_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_conj), (mp_obj_t)&ndarray_conjugate_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_angle), (mp_obj_t)&ndarray_angle_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_size), (mp_obj_t)&linalg_size_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_inv), (mp_obj_t)&linalg_inv_obj },
     { MP_ROM_QSTR(MP_QSTR_dot), (mp_obj_t)&linalg_dot_obj },
     { MP_ROM_QSTR(MP_QSTR_zeros), (mp_obj_t)&linalg_zeros_obj },
     { MP_ROM_QSTR(MP_QSTR_ones), (mp_obj_t)&linalg_ones_obj },
+    { MP_ROM_QSTR(MP_QSTR_empty), (mp_obj_t)&linalg_empty_obj },
     { MP_ROM_QSTR(MP_QSTR_eye), (mp_obj_t)&linalg_eye_obj },
     { MP_ROM_QSTR(MP_QSTR_det), (mp_obj_t)&linalg_det_obj },
     { MP_ROM_QSTR(MP_QSTR_eig), (mp_obj_t)&linalg_eig_obj },    
@@ -137,23 +204,29 @@ STATIC const mp_map_elem_t ulab_globals_table[] = {
     { MP_OBJ_NEW_QSTR(MP_QSTR_asinh), (mp_obj_t)&vectorise_asinh_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_atan), (mp_obj_t)&vectorise_atan_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_atanh), (mp_obj_t)&vectorise_atanh_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_atan2), (mp_obj_t)&vectorise_atan2_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_ceil), (mp_obj_t)&vectorise_ceil_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_copysign), (mp_obj_t)&vectorise_copysign_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_cos), (mp_obj_t)&vectorise_cos_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_erf), (mp_obj_t)&vectorise_erf_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_erfc), (mp_obj_t)&vectorise_erfc_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_exp), (mp_obj_t)&vectorise_exp_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_expm1), (mp_obj_t)&vectorise_expm1_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_floor), (mp_obj_t)&vectorise_floor_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_fmod), (mp_obj_t)&vectorise_fmod_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_gamma), (mp_obj_t)&vectorise_gamma_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_hypot), (mp_obj_t)&vectorise_hypot_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_lgamma), (mp_obj_t)&vectorise_lgamma_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_log), (mp_obj_t)&vectorise_log_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_log10), (mp_obj_t)&vectorise_log10_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_log2), (mp_obj_t)&vectorise_log2_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_pow), (mp_obj_t)&vectorise_pow_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_sin), (mp_obj_t)&vectorise_sin_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_sinh), (mp_obj_t)&vectorise_sinh_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_sqrt), (mp_obj_t)&vectorise_sqrt_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_tan), (mp_obj_t)&vectorise_tan_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_tanh), (mp_obj_t)&vectorise_tanh_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_vectorize), (mp_obj_t)&vectorise_vectorize_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_linspace), (mp_obj_t)&numerical_linspace_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_sum), (mp_obj_t)&numerical_sum_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_mean), (mp_obj_t)&numerical_mean_obj },
@@ -169,6 +242,8 @@ STATIC const mp_map_elem_t ulab_globals_table[] = {
     { MP_OBJ_NEW_QSTR(MP_QSTR_argsort), (mp_obj_t)&numerical_argsort_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_polyval), (mp_obj_t)&poly_polyval_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_polyfit), (mp_obj_t)&poly_polyfit_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_evaluate), (mp_obj_t)&evaluate_evaluate_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_lazy), (mp_obj_t)&ulab_lazy_type },
     { MP_OBJ_NEW_QSTR(MP_QSTR_fft), (mp_obj_t)&fft_fft_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_ifft), (mp_obj_t)&fft_ifft_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_spectrum), (mp_obj_t)&fft_spectrum_obj },
@@ -177,7 +252,15 @@ STATIC const mp_map_elem_t ulab_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_int8), MP_ROM_INT(NDARRAY_INT8) },
     { MP_ROM_QSTR(MP_QSTR_uint16), MP_ROM_INT(NDARRAY_UINT16) },
     { MP_ROM_QSTR(MP_QSTR_int16), MP_ROM_INT(NDARRAY_INT16) },
+    { MP_ROM_QSTR(MP_QSTR_uint32), MP_ROM_INT(NDARRAY_UINT32) },
+    { MP_ROM_QSTR(MP_QSTR_int32), MP_ROM_INT(NDARRAY_INT32) },
     { MP_ROM_QSTR(MP_QSTR_float), MP_ROM_INT(NDARRAY_FLOAT) },
+    { MP_ROM_QSTR(MP_QSTR_float32), MP_ROM_INT(NDARRAY_FLOAT32) },
+    { MP_ROM_QSTR(MP_QSTR_float16), MP_ROM_INT(NDARRAY_FLOAT16) },
+    #if ULAB_HAS_COMPLEX
+    { MP_ROM_QSTR(MP_QSTR_complex), MP_ROM_INT(NDARRAY_COMPLEX) },
+    #endif
+    { MP_ROM_QSTR(MP_QSTR_bool), MP_ROM_INT(NDARRAY_BOOL) },
 };
 
 STATIC MP_DEFINE_CONST_DICT (
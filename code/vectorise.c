@@ -11,75 +11,535 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "py/runtime.h"
 #include "py/binary.h"
 #include "py/obj.h"
 #include "py/objarray.h"
 #include "vectorise.h"
+#include "evaluate.h"
 
 #ifndef MP_PI
 #define MP_PI MICROPY_FLOAT_CONST(3.14159265358979323846)
 #endif
     
-mp_obj_t vectorise_generic_vector(mp_obj_t o_in, mp_float_t (*f)(mp_float_t)) {
+// Fast approximations of the transcendental functions in single precision. The argument is reduced 
+// to a short interval, on which a polynomial is accurate to a few units in the last place of a float; 
+// arguments, for which the reduction doesn't work, are passed to libm
+
+#define VECTORISE_LN2_HI (0.693145752f)
+#define VECTORISE_LN2_LO (1.42860677e-6f)
+
+STATIC float vectorise_approx_exp(float x) {
+    // exp(x) = 2^k exp(r), where k = round(x/ln2), and |r| <= ln2/2; results below the smallest 
+    // normal float are flushed to zero
+    if(!(x < 88.72f)) {
+        return (x != x) ? x : INFINITY;
+    }
+    if(x < -87.33f) {
+        return 0.0f;
+    }
+    int32_t k = (int32_t)(x * 1.44269504f + ((x < 0.0f) ? -0.5f : 0.5f));
+    float r = x - k * VECTORISE_LN2_HI - k * VECTORISE_LN2_LO;
+    float p = 1.0f + r * (1.0f + r * (0.5f + r * (1.0f/6.0f + r * (1.0f/24.0f + r * (1.0f/120.0f + r * (1.0f/720.0f))))));
+    // 2^k is split into two factors, so that both of them are normal floats
+    union { float f; uint32_t i; } scale1, scale2;
+    scale1.i = (uint32_t)(k/2 + 127) << 23;
+    scale2.i = (uint32_t)(k - k/2 + 127) << 23;
+    return p * scale1.f * scale2.f;
+}
+
+STATIC float vectorise_approx_log(float x) {
+    // log(x) = e ln2 + log(m), where x = m 2^e, and sqrt(1/2) <= m < sqrt(2); 
+    // log(m) = 2 atanh(s), where s = (m - 1)/(m + 1), and |s| < 0.172
+    union { float f; uint32_t i; } bits;
+    bits.f = x;
+    if((bits.i >= 0x7f800000) || (bits.i < 0x00800000)) {
+        // negative numbers, zero, subnormals, infinity, and nan
+        return ULAB_FLOAT32_C_FUN(log)(x);
+    }
+    int32_t e = (int32_t)(bits.i >> 23) - 127;
+    bits.i = (bits.i & 0x7fffff) | 0x3f800000;
+    if(bits.f > 1.41421356f) {
+        bits.f *= 0.5f;
+        e++;
+    }
+    float s = (bits.f - 1.0f) / (bits.f + 1.0f);
+    float s2 = s * s;
+    float p = 2.0f * s * (1.0f + s2 * (1.0f/3.0f + s2 * (1.0f/5.0f + s2 * (1.0f/7.0f + s2 * (1.0f/9.0f)))));
+    return e * VECTORISE_LN2_HI + (p + e * VECTORISE_LN2_LO);
+}
+
+STATIC float vectorise_approx_log2(float x) {
+    return vectorise_approx_log(x) * 1.44269504f;
+}
+
+STATIC float vectorise_approx_log10(float x) {
+    return vectorise_approx_log(x) * 0.434294482f;
+}
+
+STATIC float vectorise_approx_sincos(float x, uint8_t quadrant) {
+    // sin(x + quadrant pi/2) = +-sin(r), or +-cos(r), where x = k pi/2 + r, and |r| <= pi/4. 
+    // pi/2 is split into three parts, the first two of which have so few bits that 
+    // their products with k are exact for |x| < 1e5
+    if(!(ULAB_FLOAT32_C_FUN(fabs)(x) < 1.0e5f)) {
+        return quadrant ? ULAB_FLOAT32_C_FUN(cos)(x) : ULAB_FLOAT32_C_FUN(sin)(x);
+    }
+    int32_t k = (int32_t)(x * 0.636619772f + ((x < 0.0f) ? -0.5f : 0.5f));
+    float r = ((x - k * 1.5703125f) - k * 4.83751297e-4f) - k * 7.54978995e-8f;
+    float r2 = r * r;
+    float value;
+    quadrant = (k + quadrant) & 3;
+    if(quadrant & 1) {
+        value = 1.0f + r2 * (-0.5f + r2 * (1.0f/24.0f + r2 * (-1.0f/720.0f + r2 * (1.0f/40320.0f))));
+    } else {
+        value = r + r * r2 * (-1.0f/6.0f + r2 * (1.0f/120.0f + r2 * (-1.0f/5040.0f + r2 * (1.0f/362880.0f))));
+    }
+    return (quadrant & 2) ? -value : value;
+}
+
+STATIC float vectorise_approx_sin(float x) {
+    return vectorise_approx_sincos(x, 0);
+}
+
+STATIC float vectorise_approx_cos(float x) {
+    return vectorise_approx_sincos(x, 1);
+}
+
+#if ULAB_VECTORISE_TABLES
+// The values of the functions at the 256 possible values of uint8, and int8 are stored in a few 
+// tables, so that the elements of 8-bit arrays have only to be looked up; when all tables are 
+// in use, the oldest one is overwritten
+typedef struct _vectorise_table_t {
+    mp_float_t (*f)(mp_float_t);
+    float (*approx)(float);
+    uint8_t typecode;
+    mp_float_t values[256];
+} vectorise_table_t;
+
+STATIC vectorise_table_t vectorise_tables[ULAB_VECTORISE_TABLES];
+STATIC uint8_t vectorise_next_table = 0;
+
+STATIC mp_float_t *vectorise_table(mp_float_t (*f)(mp_float_t), float (*approx)(float), uint8_t typecode, size_t len) {
+    // returns the table of approx, or, if it is NULL, of f for the 8-bit typecode; a new table 
+    // is computed only for arrays that have at least as many elements as the table, 
+    // otherwise, NULL is returned
+    for(uint8_t i=0; i < ULAB_VECTORISE_TABLES; i++) {
+        vectorise_table_t *table = &vectorise_tables[i];
+        if((table->f == f) && (table->approx == approx) && (table->typecode == typecode)) {
+            return table->values;
+        }
+    }
+    if(len < 256) {
+        return NULL;
+    }
+    vectorise_table_t *table = &vectorise_tables[vectorise_next_table];
+    vectorise_next_table = (vectorise_next_table + 1) % ULAB_VECTORISE_TABLES;
+    // the values of int8 are indexed by their bits, i.e., -1 is at 255
+    for(uint16_t i=0; i < 256; i++) {
+        mp_float_t x = (typecode == NDARRAY_UINT8) ? (mp_float_t)i : (mp_float_t)(int8_t)i;
+        table->values[i] = (approx != NULL) ? approx(x) : f(x);
+    }
+    table->f = f;
+    table->approx = approx;
+    table->typecode = typecode;
+    return table->values;
+}
+#endif
+
+mp_obj_t vectorise_generic_vector(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args, 
+                                  mp_float_t (*f)(mp_float_t), float (*f32)(float), 
+                                  vectorise_kernel_t kernel, bool integer, float (*approx)(float)) {
+    // kernel is the function's own loop, if it has one, integer is true, if the function 
+    // maps integers to themselves, and approx is the fast approximation of the function, if any
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+        { MP_QSTR_out, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+        { MP_QSTR_approx, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = false} },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    
+    mp_obj_t o_in = args[0].u_obj;
+    mp_obj_t o_out = args[1].u_obj;
+    // functions without an approximation are always computed exactly
+    float (*approximation)(float) = args[2].u_bool ? approx : NULL;
     // Return a single value, if o_in is not iterable
     if(mp_obj_is_float(o_in) || mp_obj_is_integer(o_in)) {
-            return mp_obj_new_float(f(mp_obj_get_float(o_in)));
+        if(o_out != mp_const_none) {
+            mp_raise_TypeError("out can be used with iterables only");
+        }
+        mp_float_t value = mp_obj_get_float(o_in);
+        return mp_obj_new_float((approximation != NULL) ? approximation(value) : f(value));
+    }
+    if(MP_OBJ_IS_TYPE(o_in, &ulab_lazy_type) && (approximation != NULL)) {
+        // the evaluator knows only the library functions, hence, the lazy array is computed, 
+        // and the approximation is applied to the result
+        o_in = evaluate_lazy_run(o_in, mp_const_none);
+    }
+    if(MP_OBJ_IS_TYPE(o_in, &ulab_lazy_type)) {
+        evaluate_lazy_obj_t *lazy = MP_OBJ_TO_PTR(o_in);
+        if(!integer || (lazy->opcode != EVALUATE_LOAD) ||
+           NDARRAY_IS_FLOAT(((ndarray_obj_t *)MP_OBJ_TO_PTR(lazy->left))->array->typecode)) {
+            return evaluate_lazy_function(f, o_in, o_out);
+        }
+        // a lazy integer array is treated as the ndarray itself, so that the result
+        // keeps the integer type
+        o_in = lazy->left;
     }
-    mp_float_t x;
     if(MP_OBJ_IS_TYPE(o_in, &ulab_ndarray_type)) {
         ndarray_obj_t *source = MP_OBJ_TO_PTR(o_in);
-        ndarray_obj_t *ndarray = create_new_ndarray(source->m, source->n, NDARRAY_FLOAT);
-        mp_float_t *dataout = (mp_float_t *)ndarray->array->items;
-        if(source->array->typecode == NDARRAY_UINT8) {
-            ITERATE_VECTOR(uint8_t, source, dataout);
-        } else if(source->array->typecode == NDARRAY_INT8) {
-            ITERATE_VECTOR(int8_t, source, dataout);
-        } else if(source->array->typecode == NDARRAY_UINT16) {
-            ITERATE_VECTOR(uint16_t, source, dataout);
-        } else if(source->array->typecode == NDARRAY_INT16) {
-            ITERATE_VECTOR(int16_t, source, dataout);
+        ndarray_check_real(source);
+        ndarray_obj_t *ndarray;
+        if(integer && !NDARRAY_IS_FLOAT(source->array->typecode)) {
+            // the results are the input values, so that they are copied, and keep their type
+            if(o_out == mp_const_none) {
+                return ndarray_copy(o_in);
+            }
+            ndarray = ndarray_check_out(o_out, source->shape, source->array->typecode);
+            ndarray_copy_elements(ndarray, ndarray_detach(source, ndarray));
+            return MP_OBJ_FROM_PTR(ndarray);
+        }
+        // float32, and float16 arrays are computed in single precision, and keep their type, 
+        // all other types result in float
+        uint8_t typecode = NDARRAY_IS_FLOAT(source->array->typecode) ? source->array->typecode : NDARRAY_FLOAT;
+        if(o_out == mp_const_none) {
+            ndarray = ndarray_new_empty(source->ndim, source->shape, typecode);
+        } else {
+            // the results are written into out, which can also be the input itself
+            ndarray = ndarray_check_out(o_out, source->shape, typecode);
+            source = ndarray_detach(source, ndarray);
+        }
+        mp_float_t *table = NULL;
+        #if ULAB_VECTORISE_TABLES
+        if((source->array->typecode == NDARRAY_UINT8) || (source->array->typecode == NDARRAY_INT8)) {
+            table = vectorise_table(f, approximation, source->array->typecode, source->len);
+        }
+        #endif
+        if(table != NULL) {
+            NDARRAY_LOOP2(source->shape, uint8_t, input, source->items, source->strides, 
+                          mp_float_t, output, ndarray->items, ndarray->strides, *output = table[*input]);
+        } else if(approximation != NULL) {
+            ITERATE_VECTOR_ALL(source, ndarray, approximation, approximation);
+        } else if(kernel != NULL) {
+            kernel(source, ndarray);
         } else {
-            ITERATE_VECTOR(mp_float_t, source, dataout);
+            ITERATE_VECTOR_ALL(source, ndarray, f, f32);
         }
         return MP_OBJ_FROM_PTR(ndarray);
     } else if(MP_OBJ_IS_TYPE(o_in, &mp_type_tuple) || MP_OBJ_IS_TYPE(o_in, &mp_type_list) || 
         MP_OBJ_IS_TYPE(o_in, &mp_type_range)) { // i.e., the input is a generic iterable
-            mp_obj_array_t *o = MP_OBJ_TO_PTR(o_in);
-            ndarray_obj_t *out = create_new_ndarray(1, o->len, NDARRAY_FLOAT);
-            mp_float_t *dataout = (mp_float_t *)out->array->items;
-            mp_obj_iter_buf_t iter_buf;
-            mp_obj_t item, iterable = mp_getiter(o_in, &iter_buf);
-            size_t i=0;
-            while ((item = mp_iternext(iterable)) != MP_OBJ_STOP_ITERATION) {
-                x = mp_obj_get_float(item);
-                dataout[i++] = f(x);
+            size_t len = mp_obj_get_int(mp_obj_len(o_in));
+            ndarray_obj_t *out;
+            if(o_out == mp_const_none) {
+                out = create_empty_ndarray(1, len, NDARRAY_FLOAT);
+            } else {
+                size_t shape[ULAB_MAX_DIMS] = {1, 1, 1, len};
+                out = ndarray_check_out(o_out, shape, NDARRAY_FLOAT);
             }
+            mp_obj_iter_buf_t iter_buf;
+            mp_obj_t iterable = mp_getiter(o_in, &iter_buf);
+            NDARRAY_LOOP(out->shape, mp_float_t, dataout, out->items, out->strides, 
+                         mp_float_t value = mp_obj_get_float(mp_iternext(iterable));
+                         *dataout = (approximation != NULL) ? approximation(value) : f(value));
         return MP_OBJ_FROM_PTR(out);
     }
     return mp_const_none;
 }
 
+STATIC ndarray_obj_t *vectorise_operand(mp_obj_t obj, ndarray_obj_t *scalar, mp_obj_array_t *array, mp_float_t *value) {
+    // returns an argument of a two-argument function as an ndarray: numbers are wrapped in scalar, 
+    // as in the binary operators, lazy arrays are computed, and lists, tuples, and ranges are converted
+    if(MP_OBJ_IS_TYPE(obj, &ulab_lazy_type)) {
+        obj = evaluate_lazy_run(obj, mp_const_none);
+    } else if(MP_OBJ_IS_TYPE(obj, &mp_type_tuple) || MP_OBJ_IS_TYPE(obj, &mp_type_list) || 
+        MP_OBJ_IS_TYPE(obj, &mp_type_range)) {
+        obj = ndarray_make_new(&ulab_ndarray_type, 1, 0, &obj);
+    }
+    ndarray_obj_t *ndarray = ndarray_binary_operand(obj, scalar, array, value);
+    if(ndarray == NULL) {
+        mp_raise_TypeError("wrong input type");
+    }
+    ndarray_check_real(ndarray);
+    return ndarray;
+}
+
+STATIC void vectorise_scalar_type(mp_obj_array_t *array, mp_obj_t obj, uint8_t typecode) {
+    // A number takes the type of the other argument, if that is a float, or if the number is 
+    // an integer that doesn't change in that type, so that the two can be walked in the same loop
+    if(NDARRAY_IS_FLOAT(typecode)) {
+        ndarray_set_float_value(array->items, typecode, 0, mp_obj_get_float(obj));
+        array->typecode = typecode;
+    } else if(mp_obj_is_int(obj)) {
+        mp_float_t value;
+        ndarray_set_value(typecode, &value, 0, obj);
+        if(mp_obj_get_float(ndarray_get_value(typecode, &value, 0)) == mp_obj_get_float(obj)) {
+            memcpy(array->items, &value, ndarray_itemsize(typecode));
+            array->typecode = typecode;
+        }
+    }
+}
+
+mp_obj_t vectorise_generic_vector_2(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args, 
+                                    mp_float_t (*f)(mp_float_t, mp_float_t), float (*f32)(float, float)) {
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+        { MP_QSTR_out, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    
+    mp_obj_t o_out = args[2].u_obj;
+    if((mp_obj_is_float(args[0].u_obj) || mp_obj_is_integer(args[0].u_obj)) && 
+       (mp_obj_is_float(args[1].u_obj) || mp_obj_is_integer(args[1].u_obj))) {
+        if(o_out != mp_const_none) {
+            mp_raise_TypeError("out can be used with iterables only");
+        }
+        return mp_obj_new_float(f(mp_obj_get_float(args[0].u_obj), mp_obj_get_float(args[1].u_obj)));
+    }
+    // numbers are wrapped in ndarrays on the stack, so that they don't allocate
+    ndarray_obj_t xscalar, yscalar;
+    mp_obj_array_t xarray, yarray;
+    mp_float_t xvalue[2], yvalue[2];
+    ndarray_obj_t *x = vectorise_operand(args[0].u_obj, &xscalar, &xarray, xvalue);
+    ndarray_obj_t *y = vectorise_operand(args[1].u_obj, &yscalar, &yarray, yvalue);
+    if(x == &xscalar) {
+        vectorise_scalar_type(&xarray, args[0].u_obj, y->array->typecode);
+    }
+    if(y == &yscalar) {
+        vectorise_scalar_type(&yarray, args[1].u_obj, x->array->typecode);
+    }
+    uint8_t ndim;
+    size_t shape[ULAB_MAX_DIMS];
+    ndarray_broadcast_shape(x, y, &ndim, shape);
+    // float32, and float16 arguments are computed in single precision, and keep their type, 
+    // all other combinations result in float
+    uint8_t typecode = NDARRAY_FLOAT;
+    if((x->array->typecode == y->array->typecode) && 
+       (NDARRAY_IS_FLOAT32(x->array->typecode) || (x->array->typecode == NDARRAY_FLOAT16))) {
+        typecode = x->array->typecode;
+    }
+    ndarray_obj_t *ndarray;
+    if(o_out == mp_const_none) {
+        ndarray = ndarray_new_empty(ndim, shape, typecode);
+    } else {
+        // the results are written into out, which can also be one of the arguments
+        ndarray = ndarray_check_out(o_out, shape, typecode);
+        x = ndarray_detach(x, ndarray);
+        y = ndarray_detach(y, ndarray);
+    }
+    int32_t xstrides[ULAB_MAX_DIMS], ystrides[ULAB_MAX_DIMS];
+    ndarray_broadcast_strides(x, xstrides);
+    ndarray_broadcast_strides(y, ystrides);
+    if((x->array->typecode == y->array->typecode) && (typecode != NDARRAY_FLOAT16)) {
+        ITERATE_VECTOR_2_ALL(x, xstrides, y, ystrides, ndarray, f, f32);
+    } else {
+        // arguments of different types, and float16 are converted element by element, 
+        // and are walked in bytes
+        int32_t ostrides[ULAB_MAX_DIMS];
+        for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+            xstrides[i] *= (int32_t)ndarray_itemsize(x->array->typecode);
+            ystrides[i] *= (int32_t)ndarray_itemsize(y->array->typecode);
+            ostrides[i] = ndarray->strides[i] * (int32_t)ndarray_itemsize(typecode);
+        }
+        NDARRAY_LOOP3(shape, uint8_t, a, x->items, xstrides, uint8_t, b, y->items, ystrides, 
+                      uint8_t, c, ndarray->items, ostrides, {
+            mp_float_t u = ndarray_get_float_value(a, x->array->typecode, 0);
+            mp_float_t v = ndarray_get_float_value(b, y->array->typecode, 0);
+            ndarray_set_float_value(c, typecode, 0, (typecode == NDARRAY_FLOAT16) ? f32((float)u, (float)v) : f(u, v));
+        });
+    }
+    return MP_OBJ_FROM_PTR(ndarray);
+}
+
 MATH_FUN_1(acos, acos);
 MATH_FUN_1(acosh, acosh);
 MATH_FUN_1(asin, asin);
 MATH_FUN_1(asinh, asinh);
 MATH_FUN_1(atan, atan);
 MATH_FUN_1(atanh, atanh);
-MATH_FUN_1(ceil, ceil);
-MATH_FUN_1(cos, cos);
+MATH_FUN_2(atan2, atan2);
+MATH_KERNEL_1(ceil, ceil);
+MATH_FUN_1_INLINE(ceil, ceil, true);
+MATH_FUN_2(copysign, copysign);
+MATH_FUN_1_APPROX(cos, cos);
 MATH_FUN_1(erf, erf);
 MATH_FUN_1(erfc, erfc);
-MATH_FUN_1(exp, exp);
+MATH_FUN_1_APPROX(exp, exp);
 MATH_FUN_1(expm1, expm1);
-MATH_FUN_1(floor, floor);
+MATH_KERNEL_1(floor, floor);
+MATH_FUN_1_INLINE(floor, floor, true);
+MATH_FUN_2(fmod, fmod);
 MATH_FUN_1(gamma, tgamma);
+MATH_FUN_2(hypot, hypot);
 MATH_FUN_1(lgamma, lgamma);
-MATH_FUN_1(log, log);
-MATH_FUN_1(log10, log10);
-MATH_FUN_1(log2, log2);
-MATH_FUN_1(sin, sin);
+MATH_FUN_1_APPROX(log, log);
+MATH_FUN_1_APPROX(log10, log10);
+MATH_FUN_1_APPROX(log2, log2);
+MATH_FUN_2(pow, pow);
+MATH_FUN_1_APPROX(sin, sin);
 MATH_FUN_1(sinh, sinh);
-MATH_FUN_1(sqrt, sqrt);
+MATH_KERNEL_1(sqrt, sqrt);
+MATH_FUN_1_INLINE(sqrt, sqrt, false);
 MATH_FUN_1(tan, tan);
 MATH_FUN_1(tanh, tanh);
+
+mp_obj_t vectorise_vectorize(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
+        { MP_QSTR_otypes, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = NDARRAY_FLOAT } },
+        { MP_QSTR_cache, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = false} },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    
+    if(!mp_obj_is_callable(args[0].u_obj)) {
+        mp_raise_TypeError("first argument must be a callable");
+    }
+    uint8_t otypes = args[1].u_int;
+    bool boolean = (otypes == NDARRAY_BOOL);
+    if(boolean) {
+        otypes = NDARRAY_UINT8;
+    }
+    if((otypes != NDARRAY_UINT8) && (otypes != NDARRAY_INT8) && (otypes != NDARRAY_UINT16) && 
+       (otypes != NDARRAY_INT16) && (otypes != NDARRAY_UINT32) && (otypes != NDARRAY_INT32) && 
+       !NDARRAY_IS_FLOAT(otypes)) {
+        mp_raise_TypeError("data type not understood");
+    }
+    vectorise_vectorized_function_obj_t *function = m_new_obj(vectorise_vectorized_function_obj_t);
+    function->base.type = &ulab_vectorized_function_type;
+    function->otypes = otypes;
+    function->boolean = boolean;
+    function->cache = args[2].u_bool;
+    function->fun = args[0].u_obj;
+    mp_map_init(&function->results, 0);
+    return MP_OBJ_FROM_PTR(function);
+}
+
+STATIC mp_obj_t vectorise_box(uint8_t typecode, bool boolean, uint8_t *item) {
+    // returns the element at item as the argument of the python function; 
+    // the 8-, and 16-bit integers are small integers, and don't have to be allocated
+    switch(typecode) {
+        case NDARRAY_UINT8:
+            return boolean ? mp_obj_new_bool(*item) : MP_OBJ_NEW_SMALL_INT(*item);
+        case NDARRAY_INT8:
+            return MP_OBJ_NEW_SMALL_INT(*(int8_t *)item);
+        case NDARRAY_UINT16:
+            return MP_OBJ_NEW_SMALL_INT(*(uint16_t *)item);
+        case NDARRAY_INT16:
+            return MP_OBJ_NEW_SMALL_INT(*(int16_t *)item);
+        case NDARRAY_UINT32:
+            return mp_obj_new_int_from_uint(*(uint32_t *)item);
+        case NDARRAY_INT32:
+            return mp_obj_new_int(*(int32_t *)item);
+        default:
+            return mp_obj_new_float(ndarray_get_float_value(item, typecode, 0));
+    }
+}
+
+STATIC void vectorise_unbox(vectorise_vectorized_function_obj_t *self, uint8_t *item, mp_obj_t value) {
+    // writes the result of the python function to item; small integers are unpacked without a call, 
+    // floats are rounded to the nearest integer, if the output is an integer type
+    uint8_t otypes = self->otypes;
+    if(NDARRAY_IS_FLOAT(otypes)) {
+        ndarray_set_float_value(item, otypes, 0, mp_obj_get_float(value));
+        return;
+    }
+    int64_t i;
+    if(self->boolean) {
+        i = mp_obj_is_true(value);
+    } else if(MP_OBJ_IS_SMALL_INT(value)) {
+        i = MP_OBJ_SMALL_INT_VALUE(value);
+    } else if(mp_obj_is_float(value)) {
+        // the same conversion as in astype, and assignments: nan, and infinities become 0
+        i = ndarray_float_to_integer(mp_obj_get_float(value), ndarray_round_nearest, false, 0, 0);
+    } else {
+        i = mp_obj_get_int_truncated(value);
+    }
+    switch(otypes) {
+        case NDARRAY_UINT8:
+            *item = (uint8_t)i;
+            break;
+        case NDARRAY_INT8:
+            *(int8_t *)item = (int8_t)i;
+            break;
+        case NDARRAY_UINT16:
+            *(uint16_t *)item = (uint16_t)i;
+            break;
+        case NDARRAY_INT16:
+            *(int16_t *)item = (int16_t)i;
+            break;
+        case NDARRAY_UINT32:
+            *(uint32_t *)item = (uint32_t)i;
+            break;
+        default:
+            *(int32_t *)item = (int32_t)i;
+            break;
+    }
+}
+
+STATIC mp_obj_t vectorise_vectorized_function_apply(vectorise_vectorized_function_obj_t *self, mp_obj_t arg) {
+    // calls the python function on arg; with cache=True, the results for integer arguments are 
+    // looked up first, and are stored, until the cache is full
+    if(!self->cache || !mp_obj_is_integer(arg)) {
+        return mp_call_function_1(self->fun, arg);
+    }
+    mp_map_elem_t *elem = mp_map_lookup(&self->results, arg, MP_MAP_LOOKUP);
+    if(elem != NULL) {
+        return elem->value;
+    }
+    mp_obj_t value = mp_call_function_1(self->fun, arg);
+    if(self->results.used < ULAB_VECTORISE_CACHE) {
+        mp_map_lookup(&self->results, arg, MP_MAP_LOOKUP_ADD_IF_NOT_FOUND)->value = value;
+    }
+    return value;
+}
+
+mp_obj_t vectorise_vectorized_function_call(mp_obj_t self_in, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 1, false);
+    vectorise_vectorized_function_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_obj_t o_in = args[0];
+    if(mp_obj_is_float(o_in) || mp_obj_is_integer(o_in)) {
+        return vectorise_vectorized_function_apply(self, o_in);
+    }
+    if(MP_OBJ_IS_TYPE(o_in, &ulab_lazy_type)) {
+        o_in = evaluate_lazy_run(o_in, mp_const_none);
+    }
+    ndarray_obj_t *ndarray;
+    if(MP_OBJ_IS_TYPE(o_in, &ulab_ndarray_type)) {
+        ndarray_obj_t *source = MP_OBJ_TO_PTR(o_in);
+        ndarray_check_real(source);
+        ndarray = ndarray_new_empty(source->ndim, source->shape, self->otypes);
+        // the two arrays are walked in bytes, so that a single loop serves all types
+        int32_t in_strides[ULAB_MAX_DIMS], out_strides[ULAB_MAX_DIMS];
+        size_t in_itemsize = ndarray_itemsize(source->array->typecode);
+        size_t out_itemsize = ndarray_itemsize(self->otypes);
+        for(uint8_t i=0; i < ULAB_MAX_DIMS; i++) {
+            in_strides[i] = source->strides[i] * (int32_t)in_itemsize;
+            out_strides[i] = ndarray->strides[i] * (int32_t)out_itemsize;
+        }
+        NDARRAY_LOOP2(source->shape, uint8_t, input, source->items, in_strides, 
+                      uint8_t, output, ndarray->items, out_strides, 
+                      mp_obj_t arg = vectorise_box(source->array->typecode, source->boolean, input);
+                      vectorise_unbox(self, output, vectorise_vectorized_function_apply(self, arg)));
+    } else if(MP_OBJ_IS_TYPE(o_in, &mp_type_tuple) || MP_OBJ_IS_TYPE(o_in, &mp_type_list) || 
+        MP_OBJ_IS_TYPE(o_in, &mp_type_range)) {
+        size_t len = mp_obj_get_int(mp_obj_len(o_in));
+        ndarray = create_empty_ndarray(1, len, self->otypes);
+        size_t out_itemsize = ndarray_itemsize(self->otypes);
+        uint8_t *output = (uint8_t *)ndarray->items;
+        mp_obj_iter_buf_t iter_buf;
+        mp_obj_t iterable = mp_getiter(o_in, &iter_buf);
+        for(size_t i=0; i < len; i++, output += out_itemsize) {
+            vectorise_unbox(self, output, vectorise_vectorized_function_apply(self, mp_iternext(iterable)));
+        }
+    } else {
+        mp_raise_TypeError("argument must be a number, an ndarray, or an iterable");
+    }
+    ndarray->boolean = self->boolean;
+    return MP_OBJ_FROM_PTR(ndarray);
+}
@@ -13,40 +13,201 @@
 
 #include "ndarray.h"
 
-mp_obj_t vectorise_acos(mp_obj_t );
-mp_obj_t vectorise_acosh(mp_obj_t );
-mp_obj_t vectorise_asin(mp_obj_t );
-mp_obj_t vectorise_asinh(mp_obj_t );
-mp_obj_t vectorise_atan(mp_obj_t );
-mp_obj_t vectorise_atanh(mp_obj_t );
-mp_obj_t vectorise_ceil(mp_obj_t );
-mp_obj_t vectorise_cos(mp_obj_t );
-mp_obj_t vectorise_erf(mp_obj_t );
-mp_obj_t vectorise_erfc(mp_obj_t );
-mp_obj_t vectorise_exp(mp_obj_t );
-mp_obj_t vectorise_expm1(mp_obj_t );
-mp_obj_t vectorise_floor(mp_obj_t );
-mp_obj_t vectorise_gamma(mp_obj_t );
-mp_obj_t vectorise_lgamma(mp_obj_t );
-mp_obj_t vectorise_log(mp_obj_t );
-mp_obj_t vectorise_log10(mp_obj_t );
-mp_obj_t vectorise_log2(mp_obj_t );
-mp_obj_t vectorise_sin(mp_obj_t );
-mp_obj_t vectorise_sinh(mp_obj_t );
-mp_obj_t vectorise_sqrt(mp_obj_t );
-mp_obj_t vectorise_tan(mp_obj_t );
-mp_obj_t vectorise_tanh(mp_obj_t );
-
-#define ITERATE_VECTOR(type, souce, out) do {\
-    type *input = (type *)(source)->array->items;\
-    for(size_t i=0; i < (source)->array->len; i++) {\
-                (out)[i] = f(input[i]);\
+mp_obj_t vectorise_acos(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_acosh(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_asin(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_asinh(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_atan(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_atanh(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_atan2(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_ceil(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_copysign(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_cos(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_erf(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_erfc(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_exp(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_expm1(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_floor(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_fmod(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_gamma(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_hypot(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_lgamma(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_log(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_log10(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_log2(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_pow(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_sin(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_sinh(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_sqrt(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_tan(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_tanh(size_t , const mp_obj_t *, mp_map_t *);
+mp_obj_t vectorise_vectorize(size_t , const mp_obj_t *, mp_map_t *);
+
+// The number of the tables of the functions for uint8, and int8 arrays; each table takes 
+// 256*sizeof(mp_float_t) bytes of static RAM, i.e., the default of 2 tables costs 2 kB with 
+// single-, and 4 kB with double-precision floats. 0 disables the tables, and the functions are 
+// then calculated at each element of 8-bit arrays, too
+#ifndef ULAB_VECTORISE_TABLES
+#define ULAB_VECTORISE_TABLES (2)
+#endif
+
+// The largest number of results that a vectorized function with cache=True keeps; each result 
+// takes up two pointers in the cache
+#ifndef ULAB_VECTORISE_CACHE
+#define ULAB_VECTORISE_CACHE (256)
+#endif
+
+// A python function, which is called on each element of an ndarray, and whose results are 
+// converted to otypes; if cache is true, the results for integer arguments are kept in results
+typedef struct _vectorise_vectorized_function_obj_t {
+    mp_obj_base_t base;
+    uint8_t otypes;
+    bool boolean;
+    bool cache;
+    mp_obj_t fun;
+    mp_map_t results;
+} vectorise_vectorized_function_obj_t;
+
+extern const mp_obj_type_t ulab_vectorized_function_type;
+
+mp_obj_t vectorise_vectorized_function_call(mp_obj_t , size_t , size_t , const mp_obj_t *);
+
+// The kernel of a function writes the values of the function at the elements of source into out
+typedef void (*vectorise_kernel_t)(ndarray_obj_t *, ndarray_obj_t *);
+
+mp_obj_t vectorise_generic_vector(size_t , const mp_obj_t *, mp_map_t *, mp_float_t (*)(mp_float_t), 
+                                  float (*)(float), vectorise_kernel_t , bool , float (*)(float));
+mp_obj_t vectorise_generic_vector_2(size_t , const mp_obj_t *, mp_map_t *, mp_float_t (*)(mp_float_t, mp_float_t), 
+                                    float (*)(float, float));
+
+#define ITERATE_VECTOR(type, source, out, f) do {\
+    NDARRAY_LOOP2((source)->shape, type, input, (source)->items, (source)->strides, \
+                  mp_float_t, output, (out)->items, (out)->strides, *output = f(*input));\
+} while(0)
+
+// float32 arrays are evaluated by the single-precision version of the function, f32, 
+// and the results are float32
+#define ITERATE_VECTOR_FLOAT32(source, out, f32) do {\
+    NDARRAY_LOOP2((source)->shape, float, input, (source)->items, (source)->strides, \
+                  float, output, (out)->items, (out)->strides, *output = f32(*input));\
+} while(0)
+
+// float16 arrays are converted to float element by element, evaluated in single precision, 
+// and the results are rounded to float16
+#define ITERATE_VECTOR_FLOAT16(source, out, f32) do {\
+    NDARRAY_LOOP2((source)->shape, uint16_t, input, (source)->items, (source)->strides, \
+                  uint16_t, output, (out)->items, (out)->strides, \
+                  *output = ndarray_float_to_float16(f32((float)ndarray_float16_to_float(*input))));\
+} while(0)
+
+// Runs f, or f32 on all elements of source, with a loop for each type of the input; 
+// out must be float, unless source is float32, or float16, in which case out is of the same type
+#define ITERATE_VECTOR_ALL(source, out, f, f32) do {\
+    uint8_t _typecode = (source)->array->typecode;\
+    if(_typecode == NDARRAY_FLOAT16) {\
+        ITERATE_VECTOR_FLOAT16((source), (out), f32);\
+    } else if(NDARRAY_IS_FLOAT32(_typecode)) {\
+        ITERATE_VECTOR_FLOAT32((source), (out), f32);\
+    } else if(_typecode == NDARRAY_UINT8) {\
+        ITERATE_VECTOR(uint8_t, (source), (out), f);\
+    } else if(_typecode == NDARRAY_INT8) {\
+        ITERATE_VECTOR(int8_t, (source), (out), f);\
+    } else if(_typecode == NDARRAY_UINT16) {\
+        ITERATE_VECTOR(uint16_t, (source), (out), f);\
+    } else if(_typecode == NDARRAY_INT16) {\
+        ITERATE_VECTOR(int16_t, (source), (out), f);\
+    } else if(_typecode == NDARRAY_UINT32) {\
+        ITERATE_VECTOR(uint32_t, (source), (out), f);\
+    } else if(_typecode == NDARRAY_INT32) {\
+        ITERATE_VECTOR(int32_t, (source), (out), f);\
+    } else {\
+        ITERATE_VECTOR(mp_float_t, (source), (out), f);\
     }\
 } while(0)
 
+// Without the single-precision libm, the loops of float32 arrays get a pointer to a wrapper, 
+// which calls the double-precision function
+#if ULAB_HAS_FLOAT32 && !ULAB_FLOAT32_LIBM
+#define MATH_FLOAT32_1(c_name) \
+    STATIC float vectorise_ ## c_name ## _float32(float x) { \
+        return (float)c_name(x); \
+    }
+#define MATH_FLOAT32_2(c_name) \
+    STATIC float vectorise_ ## c_name ## _float32(float x, float y) { \
+        return (float)c_name(x, y); \
+    }
+#define MATH_FLOAT32_FUN(c_name) vectorise_ ## c_name ## _float32
+#else
+#define MATH_FLOAT32_1(c_name)
+#define MATH_FLOAT32_2(c_name)
+#define MATH_FLOAT32_FUN(c_name) c_name ## f
+#endif
+
+// The functions of libm are called through a pointer from a shared loop, which costs as much 
+// as a direct call, but saves flash
 #define MATH_FUN_1(py_name, c_name) \
-    mp_obj_t vectorise_ ## py_name(mp_obj_t x_obj) { \
-        return vectorise_generic_vector(x_obj, MICROPY_FLOAT_C_FUN(c_name)); \
+    MATH_FLOAT32_1(c_name) \
+    mp_obj_t vectorise_ ## py_name(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) { \
+        return vectorise_generic_vector(n_args, pos_args, kw_args, MICROPY_FLOAT_C_FUN(c_name), MATH_FLOAT32_FUN(c_name), \
+                                        NULL, false, NULL); \
     }
-    
+
+// Functions with a fast approximation, which is used with the approx=True keyword argument
+#define MATH_FUN_1_APPROX(py_name, c_name) \
+    MATH_FLOAT32_1(c_name) \
+    mp_obj_t vectorise_ ## py_name(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) { \
+        return vectorise_generic_vector(n_args, pos_args, kw_args, MICROPY_FLOAT_C_FUN(c_name), MATH_FLOAT32_FUN(c_name), \
+                                        NULL, false, vectorise_approx_ ## py_name); \
+    }
+
+// Functions that compile into a handful of instructions, e.g., floor, ceil, and sqrt, have their 
+// own loops, in which the calls can be inlined, and possibly vectorised by the compiler
+#define MATH_KERNEL_1(py_name, c_name) \
+    STATIC void vectorise_ ## py_name ## _kernel(ndarray_obj_t *source, ndarray_obj_t *out) { \
+        ITERATE_VECTOR_ALL(source, out, MICROPY_FLOAT_C_FUN(c_name), ULAB_FLOAT32_C_FUN(c_name)); \
+    }
+
+#define MATH_FUN_1_INLINE(py_name, c_name, integer) \
+    MATH_FLOAT32_1(c_name) \
+    mp_obj_t vectorise_ ## py_name(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) { \
+        return vectorise_generic_vector(n_args, pos_args, kw_args, MICROPY_FLOAT_C_FUN(c_name), MATH_FLOAT32_FUN(c_name), \
+                                        vectorise_ ## py_name ## _kernel, (integer), NULL); \
+    }
+
+// Runs f on the elements of x, and y, which are of the same type, and writes the results into out; 
+// the operands are walked with the strides xstrides, and ystrides, so that they can be broadcast
+#define ITERATE_VECTOR_2(type, type_out, x, xstrides, y, ystrides, out, f) do {\
+    NDARRAY_LOOP3((out)->shape, type, a, (x)->items, (xstrides), type, b, (y)->items, (ystrides), \
+                  type_out, c, (out)->items, (out)->strides, *c = f(*a, *b));\
+} while(0)
+
+// The two-argument version of ITERATE_VECTOR_ALL for operands of the same type, but float16
+#define ITERATE_VECTOR_2_ALL(x, xstrides, y, ystrides, out, f, f32) do {\
+    uint8_t _typecode = (x)->array->typecode;\
+    if(NDARRAY_IS_FLOAT32(_typecode)) {\
+        ITERATE_VECTOR_2(float, float, (x), (xstrides), (y), (ystrides), (out), f32);\
+    } else if(_typecode == NDARRAY_UINT8) {\
+        ITERATE_VECTOR_2(uint8_t, mp_float_t, (x), (xstrides), (y), (ystrides), (out), f);\
+    } else if(_typecode == NDARRAY_INT8) {\
+        ITERATE_VECTOR_2(int8_t, mp_float_t, (x), (xstrides), (y), (ystrides), (out), f);\
+    } else if(_typecode == NDARRAY_UINT16) {\
+        ITERATE_VECTOR_2(uint16_t, mp_float_t, (x), (xstrides), (y), (ystrides), (out), f);\
+    } else if(_typecode == NDARRAY_INT16) {\
+        ITERATE_VECTOR_2(int16_t, mp_float_t, (x), (xstrides), (y), (ystrides), (out), f);\
+    } else if(_typecode == NDARRAY_UINT32) {\
+        ITERATE_VECTOR_2(uint32_t, mp_float_t, (x), (xstrides), (y), (ystrides), (out), f);\
+    } else if(_typecode == NDARRAY_INT32) {\
+        ITERATE_VECTOR_2(int32_t, mp_float_t, (x), (xstrides), (y), (ystrides), (out), f);\
+    } else {\
+        ITERATE_VECTOR_2(mp_float_t, mp_float_t, (x), (xstrides), (y), (ystrides), (out), f);\
+    }\
+} while(0)
+
+// Functions of two arguments, e.g., atan2, and pow; the arguments are broadcast against each other
+#define MATH_FUN_2(py_name, c_name) \
+    MATH_FLOAT32_2(c_name) \
+    mp_obj_t vectorise_ ## py_name(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) { \
+        return vectorise_generic_vector_2(n_args, pos_args, kw_args, MICROPY_FLOAT_C_FUN(c_name), MATH_FLOAT32_FUN(c_name)); \
+    }
+
 #endif